@@ -2,79 +2,86 @@
 
 #include <xul/stripool.hpp>
 
+#include <stdexcept>
+#include <type_traits>
+
 namespace {
 
 using namespace ankerl::nanobench;
 
-const auto bench1 = Bench{}
-.epochs(1'000)
-.run("Stripool::acquire", []{
-  xul::ArrayStripool<32, 4> pool;
-  doNotOptimizeAway(pool.acquire(32));
-});
+/// Pool for the scenarios, with strips that hold two 8 byte acquisitions, or
+/// one 32 byte one, once padded for their prefix.
+template <typename Bookkeeping>
+using Pool = xul::ArrayStripool<64, 4, xul::StripLayout::interleaved, Bookkeeping>;
 
-auto bench2 = Bench{}
-.epochs(1'000)
-.run("Stripool::acquire-release", []{
-  xul::ArrayStripool<32, 4> pool;
-  auto mem = pool.acquire(32);
-  pool.release(mem);
-});
+/// Runs the *scenario* against pools of each bookkeeping configuration. The
+/// scenario is given the pool, which is created up front, so that only the
+/// scenario is timed, and must leave the pool as it found it.
+Bench compare(const char* title, auto scenario)
+{
+  Bench bench;
+  bench.title(title).epochs(1'000).relative(true);
+  const auto run = [&]<typename Bookkeeping>(const char* name, std::type_identity<Bookkeeping>) {
+    Pool<Bookkeeping> pool;
+    bench.run(name, [&]{ scenario(pool); });
+  };
+  run("u32, 8 count bits", std::type_identity<xul::StripBookkeeping<std::uint32_t, 8>>{});
+  run("u32, 16 count bits", std::type_identity<xul::StripBookkeeping<std::uint32_t, 16>>{});
+  run("u64, 16 count bits", std::type_identity<xul::StripBookkeeping<std::uint64_t, 16>>{});
+  run("u64, 32 count bits", std::type_identity<xul::StripBookkeeping<std::uint64_t, 32>>{});
+  return bench;
+}
 
-const auto bench3 = Bench{}
-.epochs(1'000)
-.run("Stripool::acquire all", []{
-  xul::ArrayStripool<32, 4> pool;
-  doNotOptimizeAway(pool.acquire(32));
-  doNotOptimizeAway(pool.acquire(32));
-  doNotOptimizeAway(pool.acquire(32));
-  doNotOptimizeAway(pool.acquire(32));
-});
+/// The *mem* a scenario expects to have acquired, failing the bench if the
+/// pool had no room, rather than releasing nullptr.
+char* acquired(char* mem)
+{
+  if ( !mem ) {
+    throw std::logic_error{"Stripool bench scenario does not fit in its pool"};
+  }
+  return mem;
+}
 
-const auto bench4 = Bench{}
-.epochs(1'000)
-.run("Stripool::acquire-release all", []{
-  xul::ArrayStripool<32, 4> pool;
-    auto mem1 = pool.acquire(32);
-    auto mem2 = pool.acquire(32);
-    auto mem3 = pool.acquire(32);
-    auto mem4 = pool.acquire(32);
-    pool.release(mem1);
-    pool.release(mem2);
-    pool.release(mem3);
-    pool.release(mem4);
+const auto bench1 = compare("Stripool::acquire-release", [](auto& pool){
+  auto mem = acquired(pool.acquire(32));
+  pool.release(mem);
 });
 
-// @todo This benchmark assumes alignof(std::max_align_t) == 16
-const auto bench5 = Bench{}
-.epochs(1'000)
-.run("Stripool::multiple acquire", []{
-  xul::ArrayStripool<32, 4> pool;
-  doNotOptimizeAway(pool.acquire(8));
-  doNotOptimizeAway(pool.acquire(8));
-
-  doNotOptimizeAway(pool.acquire(8));
-  doNotOptimizeAway(pool.acquire(8));
-
-  doNotOptimizeAway(pool.acquire(8));
-  doNotOptimizeAway(pool.acquire(8));
+const auto bench2 = compare("Stripool::acquire-release all", [](auto& pool){
+  auto mem1 = acquired(pool.acquire(32));
+  auto mem2 = acquired(pool.acquire(32));
+  auto mem3 = acquired(pool.acquire(32));
+  auto mem4 = acquired(pool.acquire(32));
+  pool.release(mem1);
+  pool.release(mem2);
+  pool.release(mem3);
+  pool.release(mem4);
+});
 
-  doNotOptimizeAway(pool.acquire(8));
-  doNotOptimizeAway(pool.acquire(8));
+/// Filling the pool, then failing to acquire, having interrogated every strip.
+const auto bench3 = compare("Stripool::acquire-release all, then fail", [](auto& pool){
+  auto mem1 = acquired(pool.acquire(32));
+  auto mem2 = acquired(pool.acquire(32));
+  auto mem3 = acquired(pool.acquire(32));
+  auto mem4 = acquired(pool.acquire(32));
+  if ( pool.acquire(32) ) {
+    throw std::logic_error{"Stripool bench scenario expected its pool to be full"};
+  }
+  pool.release(mem1);
+  pool.release(mem2);
+  pool.release(mem3);
+  pool.release(mem4);
 });
 
-const auto bench6 = Bench{}
-.epochs(1'000)
-.run("Stripool::multiple acquire-release", []{
-  xul::ArrayStripool<32, 4> pool;
-  auto mem1 = pool.acquire(8);
-  auto mem2 = pool.acquire(8);
-  auto mem3 = pool.acquire(8);
-  auto mem4 = pool.acquire(8);
-  auto mem5 = pool.acquire(8);
-  auto mem6 = pool.acquire(8);
-  auto mem7 = pool.acquire(8);
-  auto mem8 = pool.acquire(8);
+const auto bench4 = compare("Stripool::multiple acquire-release", [](auto& pool){
+  auto mem1 = acquired(pool.acquire(8));
+  auto mem2 = acquired(pool.acquire(8));
+  auto mem3 = acquired(pool.acquire(8));
+  auto mem4 = acquired(pool.acquire(8));
+  auto mem5 = acquired(pool.acquire(8));
+  auto mem6 = acquired(pool.acquire(8));
+  auto mem7 = acquired(pool.acquire(8));
+  auto mem8 = acquired(pool.acquire(8));
 
   pool.release(mem1);
   pool.release(mem2);
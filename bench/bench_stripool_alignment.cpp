@@ -0,0 +1,66 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+using Pool = xul::ArrayStripool<16384, 64>;
+
+/// Number of 64 byte acquisitions, aligned to *alignment*, that it takes to
+/// exhaust a fresh pool.
+std::size_t capacity(std::size_t alignment)
+{
+  auto pool = std::make_unique<Pool>();
+  std::size_t count = 0;
+  while ( pool->acquire(64, alignment) ) {
+    ++count;
+  }
+  return count;
+}
+
+const auto density = []{
+  std::printf("\n| alignment | 64 byte acquisitions | bytes each\n|--:|--:|--:\n");
+  for ( const std::size_t alignment : {16u, 32u, 64u, 128u, 512u, 4096u} ) {
+    const auto count = capacity(alignment);
+    std::printf("| %zu | %zu | %.1f\n", alignment, count, double(64 * Pool::raw_strip_size()) / double(count));
+  }
+  return 0;
+}();
+
+const auto pool = std::make_unique<Pool>();
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Aligned acquisition").unit("acquire-release").batch(16).relative(true);
+  std::array<char*, 16> acqs;
+  bench.run("acquire(64)", [&]{
+    for ( auto& acq : acqs ) {
+      acq = pool->acquire(64);
+      doNotOptimizeAway(acq);
+    }
+    for ( auto acq : acqs ) {
+      pool->release(acq);
+    }
+  });
+  for ( const std::size_t alignment : {16u, 64u, 512u, 4096u} ) {
+    bench.run("acquire(64, " + std::to_string(alignment) + ")", [&]{
+      for ( auto& acq : acqs ) {
+        acq = pool->acquire(64, alignment);
+        doNotOptimizeAway(acq);
+      }
+      for ( auto acq : acqs ) {
+        pool->release(acq);
+      }
+    });
+  }
+  return bench;
+}();
+
+}
@@ -0,0 +1,93 @@
+#include <nanobench.h>
+
+#include <xul/stripool_allocator.hpp>
+#include <xul/stripool_pmr.hpp>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+constexpr int element_count = 1'000;
+
+/// Room for several times the nodes of either container.
+using Pool = xul::ArrayStripool<4096, 512>;
+
+Pool pool;
+
+/// Inserts element_count elements into a fresh container, then erases them
+/// all, which is an allocation and deallocation per node.
+void fillAndEmpty(auto& list)
+{
+  for ( int i = 0; i < element_count; ++i ) {
+    list.push_back(i);
+  }
+  doNotOptimizeAway(list.back());
+  while ( !list.empty() ) {
+    list.pop_front();
+  }
+}
+
+void insertAndErase(auto& map)
+{
+  for ( int i = 0; i < element_count; ++i ) {
+    map.emplace((i * 7919) % element_count, i);
+  }
+  doNotOptimizeAway(map.size());
+  for ( int i = 0; i < element_count; ++i ) {
+    map.erase(i);
+  }
+}
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("std::list insert and erase").unit("element").batch(element_count).relative(true);
+  bench.run("std::allocator", [&]{
+    std::list<int> list;
+    fillAndEmpty(list);
+  });
+  bench.run("StripoolMemoryResource", [&]{
+    xul::StripoolMemoryResource resource{pool};
+    std::pmr::list<int> list{&resource};
+    fillAndEmpty(list);
+  });
+  bench.run("StripoolAllocator", [&]{
+    std::list<int, xul::StripoolAllocator<int>> list{xul::StripoolAllocator<int>{pool}};
+    fillAndEmpty(list);
+  });
+  bench.run("StaticStripoolAllocator", [&]{
+    std::list<int, xul::StaticStripoolAllocator<int, pool>> list;
+    fillAndEmpty(list);
+  });
+  return bench;
+}();
+
+const auto bench2 = []{
+  using Value = std::pair<const int, int>;
+  Bench bench;
+  bench.title("std::map insert and erase").unit("element").batch(element_count).relative(true);
+  bench.run("std::allocator", [&]{
+    std::map<int, int> map;
+    insertAndErase(map);
+  });
+  bench.run("StripoolMemoryResource", [&]{
+    xul::StripoolMemoryResource resource{pool};
+    std::pmr::map<int, int> map{&resource};
+    insertAndErase(map);
+  });
+  bench.run("StripoolAllocator", [&]{
+    std::map<int, int, std::less<>, xul::StripoolAllocator<Value>> map{xul::StripoolAllocator<Value>{pool}};
+    insertAndErase(map);
+  });
+  bench.run("StaticStripoolAllocator", [&]{
+    std::map<int, int, std::less<>, xul::StaticStripoolAllocator<Value, pool>> map;
+    insertAndErase(map);
+  });
+  return bench;
+}();
+
+}
@@ -0,0 +1,105 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+
+#include <array>
+#include <cstdio>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+using Pool = xul::ArrayStripool<4096, 64>;
+using StatsPool = xul::ArrayStripool<4096, 64, xul::StripLayout::interleaved, Pool::bookkeeping, xul::StripStats<>>;
+
+constexpr std::size_t max_batch = 64;
+constexpr std::uint32_t object_size = 16;
+
+struct Batch
+{
+  std::array<std::uint32_t, max_batch> sizes;
+  std::array<char*, max_batch> acqs;
+  std::size_t size;
+
+  explicit Batch(std::size_t size_) : size{size_} { sizes.fill(object_size); }
+
+  void acquireEach(auto& pool) {
+    for ( std::size_t i = 0; i < size; ++i ) {
+      acqs[i] = pool.acquire(sizes[i]);
+    }
+    doNotOptimizeAway(acqs);
+    for ( std::size_t i = 0; i < size; ++i ) {
+      pool.release(acqs[i]);
+    }
+  }
+
+  void acquireBulk(auto& pool) {
+    if ( !pool.acquire_bulk(std::span{sizes}.first(size), acqs) ) {
+      return;
+    }
+    doNotOptimizeAway(acqs);
+    pool.release_bulk(std::span{acqs}.first(size));
+  }
+};
+
+/// Compare-exchanges made per object acquired and released, by *threadCount*
+/// threads each doing *batches* of the *batchSize*, as *op* does.
+std::pair<double, double> casPerObject(unsigned threadCount, std::size_t batchSize, auto op)
+{
+  constexpr unsigned batches = 10'000;
+  StatsPool pool;
+  std::latch start{threadCount};
+  std::vector<std::thread> threads;
+  for ( unsigned t = 0; t < threadCount; ++t ) {
+    threads.push_back(std::thread{[&]{
+      Batch batch{batchSize};
+      start.arrive_and_wait();
+      for ( unsigned i = 0; i < batches; ++i ) {
+        op(batch, pool);
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  const auto stats = pool.stats();
+  const double objects = double(threadCount) * batches * batchSize;
+  return {double(stats.casAttempts) / objects, double(stats.casRetries) / objects};
+}
+
+Pool pool;
+
+const auto casCounts = []{
+  const auto each = [](Batch& batch, StatsPool& pool) { batch.acquireEach(pool); };
+  const auto bulk = [](Batch& batch, StatsPool& pool) { batch.acquireBulk(pool); };
+  std::printf(
+    "\n| threads | batch | CAS/object, each | CAS/object, bulk | failed CAS/object, each | failed CAS/object, bulk\n"
+    "|--:|--:|--:|--:|--:|--:\n");
+  for ( const unsigned threadCount : {1u, 4u} ) {
+    for ( const std::size_t batchSize : {1u, 8u, 16u, 32u, 64u} ) {
+      const auto [eachAttempts, eachFailures] = casPerObject(threadCount, batchSize, each);
+      const auto [bulkAttempts, bulkFailures] = casPerObject(threadCount, batchSize, bulk);
+      std::printf("| %u | %zu | %.3f | %.3f | %.3f | %.3f\n",
+        threadCount, batchSize, eachAttempts, bulkAttempts, eachFailures, bulkFailures);
+    }
+  }
+  return 0;
+}();
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Bulk acquisition").unit("object").relative(true);
+  for ( const std::size_t batchSize : {8u, 64u} ) {
+    Batch batch{batchSize};
+    const auto batchName = std::to_string(batchSize) + " objects";
+    bench.batch(batchSize).run("acquire, " + batchName, [&]{ batch.acquireEach(pool); });
+    bench.batch(batchSize).run("acquire_bulk, " + batchName, [&]{ batch.acquireBulk(pool); });
+  }
+  return bench;
+}();
+
+}
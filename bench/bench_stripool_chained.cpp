@@ -0,0 +1,97 @@
+#include <nanobench.h>
+
+#include <xul/stripool_chained.hpp>
+#include <xul/stripool_dynamic.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+// The primary pool is sized for the steady load of 256 live acquisitions,
+// and bursts are 8 times that.
+constexpr std::size_t steady_live = 256;
+constexpr std::size_t burst_live = steady_live * 8;
+constexpr std::uint32_t acq_size = 64;
+
+const xul::DynamicStripoolConfig segment_config{
+  .stripSize = acq_size,
+  .stripCount = steady_live};
+
+/// Pool sized for the steady load, falling back to the heap once exhausted.
+struct FallbackPool
+{
+  xul::DynamicStripool pool{segment_config};
+  std::size_t fallbacks = 0;
+
+  char* acquire(std::uint32_t size) {
+    if ( char* acq = pool.acquire(size) ) {
+      return acq;
+    }
+    ++fallbacks;
+    return new char[size];
+  }
+
+  void release(char* acq) {
+    const char* begin = static_cast<const char*>(pool.memory());
+    if ( acq >= begin && acq < begin + pool.mapped_size() ) {
+      pool.release(acq);
+    } else {
+      delete[] acq;
+    }
+  }
+};
+
+/// A steady load of acquisitions, with every tenth round being a burst.
+/// Each round acquires up to the round's live count, then releases them all.
+void bursty(auto& pool, std::vector<char*>& acqs, unsigned round)
+{
+  const auto live = round % 10 == 9 ? burst_live : steady_live;
+  for ( std::size_t i = 0; i < live; ++i ) {
+    acqs.push_back(pool.acquire(acq_size));
+    doNotOptimizeAway(acqs.back());
+  }
+  for ( auto acq : acqs ) {
+    pool.release(acq);
+  }
+  acqs.clear();
+}
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Bursty load").unit("acquire-release").batch(steady_live * 9 + burst_live).relative(true);
+  std::vector<char*> acqs;
+  acqs.reserve(burst_live);
+
+  FallbackPool fallback;
+  bench.run("DynamicStripool, heap fallback", [&]{
+    for ( unsigned round = 0; round < 10; ++round ) {
+      bursty(fallback, acqs, round);
+    }
+  });
+
+  xul::ChainedStripool chained{{.segment = segment_config, .maxSegments = 8}};
+  bench.run("ChainedStripool", [&]{
+    for ( unsigned round = 0; round < 10; ++round ) {
+      bursty(chained, acqs, round);
+    }
+  });
+
+  // Segments are trimmed after every burst, so each burst chains them on anew.
+  xul::ChainedStripool trimmed{{.segment = segment_config, .maxSegments = 8}};
+  bench.run("ChainedStripool, trimmed after bursts", [&]{
+    for ( unsigned round = 0; round < 10; ++round ) {
+      bursty(trimmed, acqs, round);
+    }
+    trimmed.trim(0);
+  });
+
+  std::printf("\nheap fallbacks: %zu, chained segments: %zu, after trimming: %zu\n",
+    fallback.fallbacks, chained.segments(), trimmed.segments());
+  return bench;
+}();
+
+}
@@ -0,0 +1,363 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+using Clock = std::chrono::steady_clock;
+
+/// Operations, each an allocation or a deallocation, made by each thread.
+constexpr unsigned contention_ops = 20'000;
+
+/// Sizes allocated, other than by the mixed sizes pattern.
+constexpr std::size_t fixed_size = 64;
+
+/// Size classes of the mixed sizes pattern, and of the thread local free
+/// lists: powers of two from 16 bytes to 1KiB.
+constexpr std::size_t size_classes = 7;
+constexpr std::size_t smallest_size = 16;
+
+std::size_t sizeClass(std::size_t size)
+{
+  return std::bit_width((std::max(size, smallest_size) - 1) / smallest_size);
+}
+
+// Every subject has the same interface, to allocate and deallocate a *size*,
+// which must be the same for both.
+
+template <typename Stats = xul::NoStripStats>
+struct StripoolSubject
+{
+  static constexpr const char* name = "Stripool";
+
+  explicit StripoolSubject(unsigned threadCount)
+    : pool{{.stripSize = 4096, .stripCount = std::max(1024u, threadCount * 64), .prefault = true}}
+  {}
+
+  /// Spins until there is room, as threads do with no fallback, so that any
+  /// exhaustion shows up in the latencies.
+  void* allocate(std::size_t size) {
+    char* acq = nullptr;
+    while ( !acq ) {
+      acq = pool.acquire(static_cast<std::uint32_t>(size));
+    }
+    return acq;
+  }
+
+  void deallocate(void* p, std::size_t) {
+    pool.release(static_cast<char*>(p));
+  }
+
+  xul::BasicDynamicStripool<xul::Stripool::bookkeeping, Stats> pool;
+};
+
+struct MallocSubject
+{
+  static constexpr const char* name = "malloc";
+
+  explicit MallocSubject(unsigned) {}
+
+  void* allocate(std::size_t size) { return std::malloc(size); }
+  void deallocate(void* p, std::size_t) { std::free(p); }
+};
+
+struct SynchronizedPoolSubject
+{
+  static constexpr const char* name = "synchronized_pool_resource";
+
+  explicit SynchronizedPoolSubject(unsigned) {}
+
+  void* allocate(std::size_t size) { return resource.allocate(size); }
+  void deallocate(void* p, std::size_t size) { resource.deallocate(p, size); }
+
+  std::pmr::synchronized_pool_resource resource;
+};
+
+/// Free lists of each size class, for the calling thread.
+struct FreeLists
+{
+  struct Node
+  {
+    Node* next;
+  };
+
+  ~FreeLists() {
+    for ( Node* head : heads ) {
+      while ( head ) {
+        std::free(std::exchange(head, head->next));
+      }
+    }
+  }
+
+  std::array<Node*, size_classes> heads{};
+};
+
+/// Free lists of each size class, kept by each thread, falling back to
+/// malloc. Memory goes on the list of whichever thread frees it, so is never
+/// contended, but drifts from producers to consumers without ever coming back.
+struct ThreadLocalFreeListSubject
+{
+  static constexpr const char* name = "thread local free list";
+
+  explicit ThreadLocalFreeListSubject(unsigned) {}
+
+  static inline thread_local FreeLists lists;
+
+  void* allocate(std::size_t size) {
+    const std::size_t c = sizeClass(size);
+    if ( FreeLists::Node* node = lists.heads[c] ) {
+      lists.heads[c] = node->next;
+      return node;
+    }
+    return std::malloc(smallest_size << c);
+  }
+
+  void deallocate(void* p, std::size_t size) {
+    const std::size_t c = sizeClass(size);
+    lists.heads[c] = ::new (p) FreeLists::Node{lists.heads[c]};
+  }
+};
+
+/// Per thread state of a pattern: its random numbers, and the latency of
+/// each operation, which includes the cost of reading the clock.
+struct Worker
+{
+  explicit Worker(unsigned threadId) : rng{threadId + 1} {
+    latencies.reserve(contention_ops);
+  }
+
+  decltype(auto) timed(auto op) {
+    const auto start = Clock::now();
+    struct Record
+    {
+      ~Record() { worker.latencies.push_back(Clock::now() - start); }
+      Worker& worker;
+      Clock::time_point start;
+    } record{*this, start};
+    return op();
+  }
+
+  Rng rng;
+  std::vector<Clock::duration> latencies;
+};
+
+/// Random-lifetime churn: each operation frees whatever is in a random slot
+/// of a window, and allocates in its place.
+void churn(auto& subject, Worker& worker, auto sizeOf)
+{
+  struct Slot { void* p = nullptr; std::size_t size = 0; };
+  std::array<Slot, 64> window;
+  for ( unsigned op = 0; op < contention_ops; op += 2 ) {
+    Slot& slot = window[worker.rng.bounded(window.size())];
+    if ( slot.p ) {
+      worker.timed([&]{ subject.deallocate(slot.p, slot.size); });
+    }
+    slot.size = sizeOf(worker.rng);
+    slot.p = worker.timed([&]{ return subject.allocate(slot.size); });
+  }
+  for ( Slot& slot : window ) {
+    if ( slot.p ) {
+      subject.deallocate(slot.p, slot.size);
+    }
+  }
+}
+
+void fixedChurn(auto& subject, Worker& worker)
+{
+  churn(subject, worker, [](Rng&){ return fixed_size; });
+}
+
+void mixedChurn(auto& subject, Worker& worker)
+{
+  churn(subject, worker, [](Rng& rng){ return smallest_size << rng.bounded(size_classes); });
+}
+
+/// Burst-then-drain: allocates a burst, then frees it all, in order.
+void burst(auto& subject, Worker& worker)
+{
+  std::array<void*, 256> burst;
+  for ( unsigned op = 0; op < contention_ops; op += 2 * burst.size() ) {
+    for ( void*& p : burst ) {
+      p = worker.timed([&]{ return subject.allocate(fixed_size); });
+    }
+    for ( void* p : burst ) {
+      worker.timed([&]{ subject.deallocate(p, fixed_size); });
+    }
+  }
+}
+
+/// Single producer, single consumer queue between a pair of threads.
+struct Handoff
+{
+  static constexpr std::size_t capacity = 256;
+
+  void push(void* p) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    while ( tail - head_.load(std::memory_order_acquire) == capacity ) {
+      std::this_thread::yield();
+    }
+    slots_[tail % capacity] = p;
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  void* pop() {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    while ( tail_.load(std::memory_order_acquire) == head ) {
+      std::this_thread::yield();
+    }
+    void* p = slots_[head % capacity];
+    head_.store(head + 1, std::memory_order_release);
+    return p;
+  }
+
+  std::array<void*, capacity> slots_;
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+/// Producer/consumer: even threads allocate and hand off to the next thread,
+/// which frees, so all memory is freed by a thread other than its allocator.
+void producerConsumer(auto& subject, Worker& worker, unsigned threadId, std::vector<Handoff>& handoffs)
+{
+  Handoff& handoff = handoffs[threadId / 2];
+  for ( unsigned op = 0; op < contention_ops; ++op ) {
+    if ( threadId % 2 == 0 ) {
+      handoff.push(worker.timed([&]{ return subject.allocate(fixed_size); }));
+    } else {
+      void* p = handoff.pop();
+      worker.timed([&]{ subject.deallocate(p, fixed_size); });
+    }
+  }
+}
+
+enum class Pattern { producerConsumer, churn, burst, mixed };
+
+constexpr const char* patternNames[] = {"producer/consumer", "random-lifetime churn", "burst-then-drain", "mixed sizes"};
+
+/// Run the *pattern* on *threadCount* threads at once, returning the latency
+/// of every operation.
+std::vector<Clock::duration> contend(auto& subject, Pattern pattern, unsigned threadCount)
+{
+  std::latch start{threadCount};
+  std::vector<Handoff> handoffs((threadCount + 1) / 2);
+  std::vector<Worker> workers;
+  for ( unsigned threadId = 0; threadId < threadCount; ++threadId ) {
+    workers.emplace_back(threadId);
+  }
+  std::vector<std::thread> threads;
+  for ( unsigned threadId = 0; threadId < threadCount; ++threadId ) {
+    threads.push_back(std::thread{[&, threadId]{
+      Worker& worker = workers[threadId];
+      start.arrive_and_wait();
+      switch ( pattern ) {
+      case Pattern::producerConsumer: producerConsumer(subject, worker, threadId, handoffs); break;
+      case Pattern::churn: fixedChurn(subject, worker); break;
+      case Pattern::burst: burst(subject, worker); break;
+      case Pattern::mixed: mixedChurn(subject, worker); break;
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  std::vector<Clock::duration> latencies;
+  for ( const auto& worker : workers ) {
+    latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+  }
+  return latencies;
+}
+
+/// The *q* quantile of the *latencies*, in nanoseconds.
+double quantile(std::vector<Clock::duration>& latencies, double q)
+{
+  if ( latencies.empty() ) {
+    return 0;
+  }
+  const auto nth = latencies.begin() + static_cast<std::ptrdiff_t>(q * double(latencies.size() - 1));
+  std::nth_element(latencies.begin(), nth, latencies.end());
+  return std::chrono::duration<double, std::nano>(*nth).count();
+}
+
+/// Thread counts to contend with: powers of two up to the hardware's
+/// concurrency, and at least a pair, for producer/consumer.
+std::vector<unsigned> threadCounts()
+{
+  std::vector<unsigned> counts;
+  for ( unsigned count = 1; count <= std::max(std::thread::hardware_concurrency(), 2u); count *= 2 ) {
+    counts.push_back(count);
+  }
+  return counts;
+}
+
+/// Compares a Stripool with malloc, a synchronized_pool_resource and thread
+/// local free lists, under each pattern of allocation on 1 to N threads.
+/// Throughput is measured by nanobench, and latencies by a separate run that
+/// reads the clock around each operation.
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Stripool contention").unit("op").epochs(3).epochIterations(1).relative(true);
+
+  struct Row { std::string name; double p50, p99, p999, casRetriesPerAcquire; };
+  std::vector<Row> rows;
+
+  for ( const auto pattern : {Pattern::producerConsumer, Pattern::churn, Pattern::burst, Pattern::mixed} ) {
+    for ( const unsigned threadCount : threadCounts() ) {
+      if ( pattern == Pattern::producerConsumer && threadCount % 2 != 0 ) {
+        continue;
+      }
+      const auto compare = [&]<typename Subject>(std::type_identity<Subject>) {
+        const std::string name = std::string{patternNames[static_cast<int>(pattern)]} + ", "
+          + std::to_string(threadCount) + " threads, " + Subject::name;
+        Subject subject{threadCount};
+        bench.batch(threadCount * contention_ops).run(name, [&]{ contend(subject, pattern, threadCount); });
+
+        auto latencies = contend(subject, pattern, threadCount);
+        Row row{name, quantile(latencies, 0.5), quantile(latencies, 0.99), quantile(latencies, 0.999), -1};
+        // Contention is counted by a separate run with a pool that records
+        // stats, so as not to count the cost of recording in the timings.
+        if constexpr ( std::is_same_v<Subject, StripoolSubject<>> ) {
+          StripoolSubject<xul::StripStats<>> statsSubject{threadCount};
+          contend(statsSubject, pattern, threadCount);
+          const auto stats = statsSubject.pool.stats();
+          row.casRetriesPerAcquire = double(stats.casRetries) / double(stats.acquires);
+        }
+        rows.push_back(row);
+      };
+      compare(std::type_identity<StripoolSubject<>>{});
+      compare(std::type_identity<MallocSubject>{});
+      compare(std::type_identity<SynchronizedPoolSubject>{});
+      compare(std::type_identity<ThreadLocalFreeListSubject>{});
+    }
+  }
+
+  std::printf("\n| scenario | p50 ns | p99 ns | p999 ns | CAS retries/acquire-release\n|:--|--:|--:|--:|--:\n");
+  for ( const auto& row : rows ) {
+    std::printf("| %s | %.0f | %.0f | %.0f | ", row.name.c_str(), row.p50, row.p99, row.p999);
+    if ( row.casRetriesPerAcquire < 0 ) {
+      std::printf("-\n");
+    } else {
+      std::printf("%.4f\n", row.casRetriesPerAcquire);
+    }
+  }
+  return bench;
+}();
+
+}
@@ -0,0 +1,65 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// Times creating a 256MiB pool of 4KiB strips, then filling every strip
+/// for the first time, which is when the pages are faulted in unless the pool
+/// was prefaulted. These are one off costs, so are timed once, rather than
+/// by nanobench.
+const auto firstTouch = []{
+  constexpr std::size_t strip_size = 4096 - 32;
+  constexpr std::size_t strip_count = 65536;
+
+  std::printf("\n| pages | prefault | create (ms) | first fill (ms) | second fill (ms)\n|:--|:--|--:|--:|--:\n");
+  for ( const auto pages : {xul::StripPages::standard, xul::StripPages::transparent_huge, xul::StripPages::huge} ) {
+    for ( const bool prefault : {false, true} ) {
+      auto start = Clock::now();
+      xul::DynamicStripool pool{{
+        .stripSize = strip_size,
+        .stripCount = strip_count,
+        .pages = pages,
+        .prefault = prefault}};
+      const auto createMs = msSince(start);
+
+      std::vector<char*> acqs(strip_count);
+      double fillMs[2];
+      for ( auto& ms : fillMs ) {
+        start = Clock::now();
+        for ( auto& acq : acqs ) {
+          acq = pool.acquire(strip_size);
+          std::memset(acq, 1, strip_size);
+        }
+        ms = msSince(start);
+        for ( auto acq : acqs ) {
+          pool.release(acq);
+        }
+      }
+
+      const char* pagesName =
+        pool.pages() == xul::StripPages::standard ? "standard" :
+        pool.pages() == xul::StripPages::transparent_huge ? "transparent huge" :
+        "huge";
+      std::printf("| %s | %s | %.1f | %.1f | %.1f\n",
+        pagesName, prefault ? "yes" : "no", createMs, fillMs[0], fillMs[1]);
+    }
+  }
+  return 0;
+}();
+
+}
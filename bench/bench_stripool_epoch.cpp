@@ -0,0 +1,162 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+#include <xul/stripool_epoch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+constexpr std::size_t list_length = 256;
+constexpr unsigned traversals = 2'000;
+
+struct Node
+{
+  std::atomic<Node*> next;
+  std::uint64_t value;
+};
+
+/// Linked list whose nodes are acquired from a pool, and are replaced with
+/// updated copies by a writer while readers traverse it.
+struct List
+{
+  explicit List(xul::DynamicStripool& pool_) : pool{pool_} {
+    for ( std::size_t i = 0; i < list_length; ++i ) {
+      head.store(make(head.load(std::memory_order_relaxed), i), std::memory_order_relaxed);
+    }
+  }
+
+  ~List() {
+    for ( Node* node = head.load(); node; ) {
+      xul::Stripool::release(reinterpret_cast<char*>(std::exchange(node, node->next.load())));
+    }
+  }
+
+  Node* make(Node* next, std::uint64_t value) {
+    char* mem = pool.acquire(sizeof(Node));
+    return mem ? ::new (mem) Node{{next}, value} : nullptr;
+  }
+
+  std::uint64_t sum() const {
+    std::uint64_t sum = 0;
+    for ( Node* node = head.load(std::memory_order_acquire); node; node = node->next.load(std::memory_order_acquire) ) {
+      sum += node->value;
+    }
+    return sum;
+  }
+
+  /// Replace the *i*th node with an updated copy, returning the unlinked
+  /// node for the caller to dispose of, or nullptr if the pool had no room.
+  Node* replace(std::size_t i) {
+    std::atomic<Node*>* link = &head;
+    for ( ; i > 0; --i ) {
+      link = &link->load(std::memory_order_relaxed)->next;
+    }
+    Node* old = link->load(std::memory_order_relaxed);
+    Node* copy = make(old->next.load(std::memory_order_relaxed), old->value + 1);
+    if ( copy ) {
+      link->store(copy, std::memory_order_release);
+    }
+    return copy ? old : nullptr;
+  }
+
+  xul::DynamicStripool& pool;
+  std::atomic<Node*> head{nullptr};
+};
+
+/// Have *readerCount* threads each traverse the list, with *read*, while a
+/// writer replaces nodes at random, with *write*, until the readers are done.
+void readMostly(unsigned readerCount, auto read, auto write)
+{
+  std::latch start{readerCount + 1};
+  std::atomic<unsigned> reading{readerCount};
+  std::vector<std::thread> threads;
+  for ( unsigned reader = 0; reader < readerCount; ++reader ) {
+    threads.push_back(std::thread{[&]{
+      auto reads = read();
+      start.arrive_and_wait();
+      for ( unsigned traversal = 0; traversal < traversals; ++traversal ) {
+        doNotOptimizeAway(reads());
+      }
+      reading.fetch_sub(1, std::memory_order_release);
+    }});
+  }
+  threads.push_back(std::thread{[&]{
+    auto writes = write();
+    Rng rng{readerCount};
+    start.arrive_and_wait();
+    while ( reading.load(std::memory_order_acquire) > 0 ) {
+      writes(rng.bounded(list_length));
+    }
+  }});
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+}
+
+/// Compares readers traversing a list while it is updated, with epoch based
+/// reclamation, which lets readers go without any locking, and with a reader
+/// writer lock, which lets the writer release replaced nodes straight away.
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Read mostly list").unit("traversal").epochs(3).epochIterations(1).relative(true);
+  xul::DynamicStripool pool{{.stripSize = 4096, .stripCount = 4096, .prefault = true}};
+
+  for ( unsigned readerCount = 1; readerCount <= std::max(std::thread::hardware_concurrency(), 2u); readerCount *= 2 ) {
+    bench.batch(readerCount * traversals);
+
+    List epochList{pool};
+    xul::StripEpochs epochs;
+    bench.run(std::to_string(readerCount) + " readers, StripEpochs", [&]{
+      readMostly(readerCount,
+        [&]{
+          return [&, participant = std::make_unique<xul::StripEpochs<>::Participant>(epochs)]{
+            auto guard = participant->guard();
+            return epochList.sum();
+          };
+        },
+        [&]{
+          return [&, participant = std::make_unique<xul::StripEpochs<>::Participant>(epochs)](std::size_t i){
+            if ( Node* old = epochList.replace(i) ) {
+              participant->retire(reinterpret_cast<char*>(old));
+            }
+          };
+        });
+    });
+
+    List lockedList{pool};
+    std::shared_mutex mutex;
+    bench.run(std::to_string(readerCount) + " readers, shared_mutex", [&]{
+      readMostly(readerCount,
+        [&]{
+          return [&]{
+            const std::shared_lock lock{mutex};
+            return lockedList.sum();
+          };
+        },
+        [&]{
+          return [&](std::size_t i){
+            const std::scoped_lock lock{mutex};
+            if ( Node* old = lockedList.replace(i) ) {
+              xul::Stripool::release(reinterpret_cast<char*>(old));
+            }
+          };
+        });
+    });
+  }
+  return bench;
+}();
+
+}
@@ -0,0 +1,50 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+#include <xul/stripool_magazine.hpp>
+
+#include <array>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+/// A request's worth of small acquisitions, which are all released once the
+/// request is handled.
+void request(auto& acquirer)
+{
+  std::array<char*, 16> acqs;
+  for ( std::size_t i = 0; i < acqs.size(); ++i ) {
+    acqs[i] = acquirer.acquire(16 + 8 * i);
+    doNotOptimizeAway(acqs[i]);
+  }
+  for ( char* acq : acqs ) {
+    acquirer.release(acq);
+  }
+}
+
+/// Compares acquiring from a pool directly, which is an exchange on a strip
+/// header for every acquisition and release, with acquiring from a magazine,
+/// which only exchanges to release, and to move on to a new chunk.
+const auto bench1 = []{
+  xul::DynamicStripool pool{{.stripSize = 4096, .stripCount = 64, .prefault = true}};
+  xul::StripMagazine magazine{pool};
+
+  Bench bench;
+  bench.title("StripMagazine").relative(true);
+  bench.unit("acquire-release").run("Stripool", [&]{
+    pool.release(pool.acquire(48));
+  });
+  bench.run("StripMagazine", [&]{
+    magazine.release(magazine.acquire(48));
+  });
+  bench.unit("acquisition").batch(16).run("Stripool, request", [&]{
+    request(pool);
+  });
+  bench.run("StripMagazine, request", [&]{
+    request(magazine);
+  });
+  return bench;
+}();
+
+}
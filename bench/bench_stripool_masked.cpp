@@ -0,0 +1,73 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+#include <xul/stripool_masked.hpp>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+// Both pools have 16 strips of 4KiB.
+using Pool = xul::ArrayStripool<4096 - 32, 16>;
+using MaskedPool = xul::ArrayMaskedStripool<4096, 16>;
+static_assert(Pool::raw_strip_size() == 4096);
+
+/// Number of *size* byte acquisitions it takes to exhaust the *pool*.
+std::size_t capacity(auto& pool, std::uint32_t size)
+{
+  std::size_t count = 0;
+  while ( pool.acquire(size) ) {
+    ++count;
+  }
+  return count;
+}
+
+const auto density = []{
+  std::printf(
+    "\n| size | Stripool acquisitions | bytes each | MaskedStripool acquisitions | bytes each\n"
+    "|--:|--:|--:|--:|--:\n");
+  for ( const std::uint32_t size : {8u, 16u, 24u, 32u, 64u} ) {
+    // Pools are made afresh for each size, and kept off the stack.
+    const auto poolCount = capacity(*std::make_unique<Pool>(), size);
+    const auto maskedCount = capacity(*std::make_unique<MaskedPool>(), size);
+    std::printf("| %u | %zu | %.1f | %zu | %.1f\n",
+      size,
+      poolCount, 16.0 * 4096 / poolCount,
+      maskedCount, 16.0 * 4096 / maskedCount);
+  }
+  return 0;
+}();
+
+/// Acquires 16 lots of *size* bytes, then releases them all.
+void acquireRelease(auto& pool, std::uint32_t size)
+{
+  std::array<char*, 16> acqs;
+  for ( auto& acq : acqs ) {
+    acq = pool.acquire(size);
+    doNotOptimizeAway(acq);
+  }
+  for ( auto acq : acqs ) {
+    pool.release(acq);
+  }
+}
+
+Pool pool;
+MaskedPool masked;
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Masked Stripool").unit("acquire-release").batch(16).relative(true);
+  for ( const std::uint32_t size : {8u, 32u} ) {
+    const auto sizeName = std::to_string(size) + " bytes";
+    bench.run("Stripool, " + sizeName, [&]{ acquireRelease(pool, size); });
+    bench.run("MaskedStripool, " + sizeName, [&]{ acquireRelease(masked, size); });
+  }
+  return bench;
+}();
+
+}
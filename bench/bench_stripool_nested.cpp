@@ -0,0 +1,127 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+
+#include <array>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+using Pool = xul::ArrayStripool<1024, 16>;
+using StatsPool = xul::ArrayStripool<1024, 16, xul::StripLayout::interleaved, Pool::bookkeeping, xul::StripStats<>>;
+
+constexpr std::size_t max_depth = 16;
+constexpr std::uint32_t object_size = 48;
+constexpr std::size_t kept_runs = 8;
+
+/// Acquires for *depth* nested scopes, each acquiring on entry and releasing
+/// on exit, which is stack order, or releasing every scope's acquisition only
+/// once the innermost exits, outermost first, which is not. Each run also
+/// keeps an acquisition for the following kept_runs runs, as a request would
+/// keep its context, which keeps its strip from being reset for a while.
+template <bool stack_order_>
+struct NestedScopes
+{
+  std::array<char*, kept_runs> kept{};
+  std::size_t runs = 0;
+
+  void operator()(auto& pool, std::size_t depth, auto onAcquired) {
+    char*& keep = kept[runs++ % kept_runs];
+    if ( keep ) {
+      pool.release(keep);
+    }
+    keep = pool.acquire_wait(object_size);
+    onAcquired(keep);
+    std::array<char*, max_depth> acqs;
+    for ( std::size_t i = 0; i < depth; ++i ) {
+      acqs[i] = pool.acquire_wait(object_size);
+      onAcquired(acqs[i]);
+    }
+    doNotOptimizeAway(acqs);
+    if constexpr ( stack_order_ ) {
+      for ( std::size_t i = depth; i-- > 0; ) {
+        pool.release(acqs[i]);
+      }
+    } else {
+      for ( std::size_t i = 0; i < depth; ++i ) {
+        pool.release(acqs[i]);
+      }
+    }
+  }
+
+  void operator()(auto& pool, std::size_t depth) {
+    (*this)(pool, depth, [](char*){});
+  }
+
+  void releaseKept(auto& pool) {
+    for ( char*& keep : kept ) {
+      if ( keep ) {
+        pool.release(keep);
+        keep = nullptr;
+      }
+    }
+  }
+};
+
+/// Tabulates how often acquisitions move on to another strip than the one
+/// the previous acquisition came from. Acquisitions in stack order move the
+/// head back as they are released, so only the kept acquisitions fill the
+/// strip, whereas otherwise every scope's acquisitions do.
+const auto rotations = []{
+  std::printf(
+    "\n| order | depth | strip rotations/run | strip resets/run | head rollbacks/run\n"
+    "|:--|--:|--:|--:|--:\n");
+  const auto tabulate = [](const char* order, std::size_t depth, auto scopes) {
+    constexpr unsigned runs = 100'000;
+    StatsPool pool;
+    const char* memory = static_cast<const char*>(pool.memory());
+    std::size_t strip = 0;
+    std::size_t rotations = 0;
+    const auto onAcquired = [&](char* acq) {
+      const std::size_t acqStrip = (acq - memory) / StatsPool::raw_strip_size();
+      rotations += acqStrip != strip;
+      strip = acqStrip;
+    };
+    for ( unsigned i = 0; i < runs; ++i ) {
+      scopes(pool, depth, onAcquired);
+    }
+    scopes.releaseKept(pool);
+    const auto stats = pool.stats();
+    std::printf("| %s | %zu | %.4f | %.4f | %.4f\n",
+      order,
+      depth,
+      double(rotations) / runs,
+      double(stats.stripResets) / runs,
+      double(stats.headRollbacks) / runs);
+  };
+  for ( const std::size_t depth : {2u, 4u, 8u} ) {
+    tabulate("stack", depth, NestedScopes<true>{});
+    tabulate("outermost first", depth, NestedScopes<false>{});
+  }
+  return 0;
+}();
+
+Pool pool;
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Nested scopes").unit("acquisition").relative(true);
+  for ( const std::size_t depth : {4u, 8u} ) {
+    NestedScopes<true> stack;
+    bench.batch(depth + 1).run("stack order, depth " + std::to_string(depth), [&]{
+      stack(pool, depth);
+    });
+    stack.releaseKept(pool);
+    NestedScopes<false> outermostFirst;
+    bench.batch(depth + 1).run("outermost first, depth " + std::to_string(depth), [&]{
+      outermostFirst(pool, depth);
+    });
+    outermostFirst.releaseKept(pool);
+  }
+  return bench;
+}();
+
+}
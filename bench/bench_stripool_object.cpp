@@ -0,0 +1,44 @@
+#include <nanobench.h>
+
+#include <xul/stripool_object.hpp>
+
+#include <memory>
+#include <new>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+struct Object
+{
+  explicit Object(int value_) : value{value_} {}
+  int value;
+  char payload[60];
+};
+
+xul::ArrayStripool<4096, 64> pool;
+
+/// Pooled objects should cost no more than acquiring, constructing,
+/// destroying and releasing by hand.
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Object lifetime").unit("object").relative(true);
+  bench.run("std::make_unique", [&]{
+    auto object = std::make_unique<Object>(1);
+    doNotOptimizeAway(object.get());
+  });
+  bench.run("acquire, new, destroy, release", [&]{
+    char* mem = pool.acquire(sizeof(Object));
+    Object* object = ::new (mem) Object(1);
+    doNotOptimizeAway(object);
+    std::destroy_at(object);
+    pool.release(mem);
+  });
+  bench.run("make_pooled", [&]{
+    auto object = xul::make_pooled<Object>(pool, 1);
+    doNotOptimizeAway(object.get());
+  });
+  return bench;
+}();
+
+}
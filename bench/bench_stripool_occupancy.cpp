@@ -0,0 +1,71 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+constexpr std::size_t strip_size = 192;
+
+/// Pool of *stripCount* strips with every strip but a random 5% holding an
+/// acquisition that fills it, kept for as long as the pool.
+template <typename Occupancy>
+struct MostlyFull
+{
+  explicit MostlyFull(std::size_t stripCount)
+    : pool{{.stripSize = strip_size, .stripCount = stripCount, .prefault = true}}
+  {
+    std::vector<char*> acqs(stripCount);
+    for ( auto& acq : acqs ) {
+      acq = pool.acquire(strip_size);
+    }
+    Rng rng{stripCount};
+    rng.shuffle(acqs);
+    freeCount = stripCount / 20;
+    for ( std::size_t i = 0; i < freeCount; ++i ) {
+      pool.release(acqs[i]);
+    }
+    burst.resize(freeCount);
+  }
+
+  /// Fill every free strip, one acquisition at a time, then free them again.
+  void fillAndDrain() {
+    for ( auto& acq : burst ) {
+      acq = pool.acquire(strip_size);
+    }
+    for ( auto acq : burst ) {
+      pool.release(acq);
+    }
+  }
+
+  xul::BasicDynamicStripool<xul::Stripool::bookkeeping, xul::NoStripStats, Occupancy> pool;
+  std::size_t freeCount;
+  std::vector<char*> burst;
+};
+
+/// Compares finding the free strips of pools that are 95% full, by looking at
+/// each strip in turn, and with an occupancy bitmap. Looking at each strip
+/// costs a cache miss per full strip passed over, which grows with the pool
+/// as it outgrows the caches, while the bitmap skips 64 strips at a time.
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Stripool, 95% full").unit("acquire-release").relative(true);
+  for ( const std::size_t stripCount : {1'024uz, 4'096uz, 16'384uz, 65'536uz} ) {
+    MostlyFull<xul::NoStripOccupancy> scanning{stripCount};
+    bench.batch(scanning.freeCount).run(std::to_string(stripCount) + " strips, scanning", [&]{
+      scanning.fillAndDrain();
+    });
+    MostlyFull<xul::StripOccupancy> skipping{stripCount};
+    bench.batch(skipping.freeCount).run(std::to_string(stripCount) + " strips, occupancy bitmap", [&]{
+      skipping.fillAndDrain();
+    });
+  }
+  return bench;
+}();
+
+}
@@ -0,0 +1,46 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+#include <xul/stripool_pmr.hpp>
+
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+/// Move assigning a std::pmr::vector between resources that compare equal
+/// takes its storage, whereas between those that don't, moves its elements
+/// one by one into storage from the destination's resource. Resources over
+/// different pools compare equal when neither has an upstream to overflow to,
+/// so the cost should stay flat however many elements there are, and only
+/// grow with them for different upstreams.
+const auto bench1 = []{
+  xul::DynamicStripool pool1{{.stripSize = 1024 * 1024, .stripCount = 4}};
+  xul::DynamicStripool pool2{{.stripSize = 1024 * 1024, .stripCount = 4}};
+  xul::StripoolMemoryResource resource1{pool1};
+  xul::StripoolMemoryResource resource2{pool2};
+  xul::StripoolMemoryResource otherUpstream{pool2, std::pmr::new_delete_resource()};
+
+  Bench bench;
+  bench.title("std::pmr::vector move assignment").relative(true);
+  for ( const std::size_t size : {16u, 1'024u, 65'536u} ) {
+    const auto moveBackAndForth = [&](const char* name, std::pmr::memory_resource& destination) {
+      std::pmr::vector<int> from(size, 1, &resource1);
+      std::pmr::vector<int> to{&destination};
+      bench.run(std::string{name} + ", " + std::to_string(size) + " ints", [&]{
+        to = std::move(from);
+        from = std::move(to);
+        doNotOptimizeAway(from.data());
+      });
+    };
+    moveBackAndForth("same upstream", resource2);
+    moveBackAndForth("different upstream", otherUpstream);
+  }
+  return bench;
+}();
+
+}
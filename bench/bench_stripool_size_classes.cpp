@@ -0,0 +1,120 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+#include <xul/stripool_size_classes.hpp>
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+// Both pools have 256 strips of 4KiB, between them, with the size classes
+// given strips in proportion to the bytes the mixed workload acquires of them.
+using SinglePool = xul::ArrayStripool<4096, 256>;
+using ClassPool = xul::SizeClassStripool<
+  xul::StripSizeClass<64, 4096, 16>,
+  xul::StripSizeClass<256, 4096, 32>,
+  xul::StripSizeClass<1024, 4096, 64>,
+  xul::StripSizeClass<4096, 4096, 144>>;
+
+/// Acquisitions of the mixed workload, which keeps *live* acquisitions of
+/// between 8 bytes and 4KiB, skewed towards the smaller sizes, and replaces
+/// one at random each step.
+template <std::size_t live>
+struct MixedWorkload
+{
+  struct Acq { char* mem; bool heap; };
+  std::array<Acq, live> acqs{};
+  Rng rng{1};
+  std::size_t failures = 0;
+
+  std::uint32_t nextSize() {
+    // Each power of two from 8 to 2KiB is equally likely, up to double that.
+    const std::uint32_t base = 8u << rng.bounded(9);
+    return base + rng.bounded(base + 1);
+  }
+
+  /// Replace a random live acquisition with a fresh one from the *pool*,
+  /// falling back to the heap, as a real application would, when the pool
+  /// cannot provide it.
+  void step(auto& pool) {
+    Acq& acq = acqs[rng.bounded(live)];
+    if ( acq.mem ) {
+      acq.heap ? std::free(acq.mem) : pool.release(acq.mem);
+    }
+    const auto size = nextSize();
+    acq.mem = pool.acquire(size);
+    acq.heap = !acq.mem;
+    if ( acq.heap ) {
+      ++failures;
+      acq.mem = static_cast<char*>(std::malloc(size));
+    }
+    doNotOptimizeAway(acq.mem);
+  }
+
+  void clear(auto& pool) {
+    for ( auto& acq : acqs ) {
+      if ( acq.mem ) {
+        acq.heap ? std::free(acq.mem) : pool.release(acq.mem);
+      }
+      acq = {};
+    }
+  }
+};
+
+/// The malloc counterpart of the pools, for the mixed workload to use.
+struct Malloc
+{
+  char* acquire(std::uint32_t size) { return static_cast<char*>(std::malloc(size)); }
+  void release(char* mem) { std::free(mem); }
+};
+
+const auto singlePool = std::make_unique<SinglePool>();
+const auto classPool = std::make_unique<ClassPool>();
+
+/// Fragmentation, as the proportion of the mixed workload's acquisitions that
+/// the pools fail to provide, as the number of live acquisitions goes up.
+const auto fragmentation = []{
+  std::printf("\n| live acquisitions | single pool failures | size class pool failures\n|--:|--:|--:\n");
+  constexpr std::size_t steps = 100'000;
+  const auto failureRate = [](auto& workload, auto& pool) {
+    for ( std::size_t i = 0; i < steps; ++i ) {
+      workload.step(pool);
+    }
+    workload.clear(pool);
+    return 100.0 * double(workload.failures) / steps;
+  };
+  const auto row = [&]<std::size_t live>(std::integral_constant<std::size_t, live>) {
+    auto single = std::make_unique<MixedWorkload<live>>();
+    auto classes = std::make_unique<MixedWorkload<live>>();
+    std::printf("| %zu | %.1f%% | %.1f%%\n",
+      live, failureRate(*single, *singlePool), failureRate(*classes, *classPool));
+  };
+  row(std::integral_constant<std::size_t, 64>{});
+  row(std::integral_constant<std::size_t, 128>{});
+  row(std::integral_constant<std::size_t, 256>{});
+  row(std::integral_constant<std::size_t, 512>{});
+  row(std::integral_constant<std::size_t, 1024>{});
+  return 0;
+}();
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Mixed sizes").unit("acquire-release").relative(true);
+  auto workload = std::make_unique<MixedWorkload<128>>();
+  Malloc heap;
+
+  bench.run("malloc", [&]{ workload->step(heap); });
+  workload->clear(heap);
+  bench.run("Single Stripool", [&]{ workload->step(*singlePool); });
+  workload->clear(*singlePool);
+  bench.run("SizeClassStripool", [&]{ workload->step(*classPool); });
+  workload->clear(*classPool);
+  return bench;
+}();
+
+}
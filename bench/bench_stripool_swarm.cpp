@@ -0,0 +1,100 @@
+#include <nanobench.h>
+
+#include <xul/stripool.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+constexpr unsigned swarm_ops = 10'000;
+
+/// The scenario of the Stripool.DISABLED_Swarm test: every thread repeatedly
+/// acquires 8 bytes, fills them with its ID *fills* times, and releases them
+/// again.
+void swarm(auto& pool, unsigned threadCount, unsigned fills = 1)
+{
+  std::latch start{threadCount};
+  std::vector<std::thread> threads;
+  for ( unsigned threadId = 0; threadId < threadCount; ++threadId ) {
+    threads.push_back(std::thread{[threadId, fills, &start, &pool]{
+      start.arrive_and_wait();
+      for ( unsigned op = 0; op < swarm_ops; ++op ) {
+        char* acq = nullptr;
+        while ( !acq ) {
+          acq = pool.acquire(8);
+        }
+        for ( unsigned fill = 0; fill < fills; ++fill ) {
+          std::memset(acq, static_cast<int>(threadId + fill), 8);
+          doNotOptimizeAway(acq);
+        }
+        pool.release(acq);
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+}
+
+const auto bench1 = []{
+  Bench bench;
+  bench.title("Stripool swarm").unit("acquire-release").epochs(5).epochIterations(1);
+
+  struct Row { unsigned threads; const char* affinity; double casFailuresPerOp; };
+  std::vector<Row> rows;
+
+  for ( const unsigned threadCount : {1u, 2u, 4u, 8u, 16u, 24u} ) {
+    for ( const auto affinity : {xul::StripAffinity::shared, xul::StripAffinity::thread} ) {
+      const char* affinityName = affinity == xul::StripAffinity::shared ? "shared" : "thread";
+      xul::ArrayStripool<32, 12> pool{affinity};
+      bench.batch(threadCount * swarm_ops).run(
+        std::to_string(threadCount) + " threads, " + affinityName + " affinity",
+        [&]{ swarm(pool, threadCount); });
+
+      // Contention is counted by a separate run with a pool that records
+      // stats, so as not to count the cost of recording in the timings.
+      xul::ArrayStripool<32, 12, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<>> statsPool{affinity};
+      swarm(statsPool, threadCount);
+      const auto stats = statsPool.stats();
+      rows.push_back({threadCount, affinityName, double(stats.casRetries) / double(stats.acquires)});
+    }
+  }
+
+  std::printf("\n| threads | affinity | CAS failures/acquire-release\n|--:|:--|--:\n");
+  for ( const auto& row : rows ) {
+    std::printf("| %u | %s | %.4f\n", row.threads, row.affinity, row.casFailuresPerOp);
+  }
+  return bench;
+}();
+
+/// Compares interleaved and isolated strip headers, for strips small enough
+/// that two interleaved strips share a cache line. Threads have their own
+/// strips, so any contention between them is down to the layout.
+template <xul::StripLayout layout_>
+void layoutSwarm(Bench& bench, const char* layoutName, unsigned threadCount)
+{
+  xul::ArrayStripool<8, 24, layout_> pool{xul::StripAffinity::thread};
+  bench.batch(threadCount * swarm_ops).run(
+    std::to_string(threadCount) + " threads, " + layoutName + " headers",
+    [&]{ swarm(pool, threadCount, 16); });
+}
+
+const auto bench2 = []{
+  Bench bench;
+  bench.title("Stripool layout").unit("acquire-release").epochs(5).epochIterations(1);
+  for ( const unsigned threadCount : {1u, 2u, 4u, 8u, 16u, 24u} ) {
+    layoutSwarm<xul::StripLayout::interleaved>(bench, "interleaved", threadCount);
+    layoutSwarm<xul::StripLayout::isolated>(bench, "isolated", threadCount);
+  }
+  return bench;
+}();
+
+}
@@ -0,0 +1,80 @@
+#include <nanobench.h>
+
+#include <xul/stripool_dynamic.hpp>
+#include <xul/stripool_trace.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <initializer_list>
+#include <latch>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ankerl::nanobench;
+
+/// Traces threads that each keep a window of acquisitions of 16 to 256
+/// bytes, replacing one at random at a time, on a pool with room to spare.
+std::vector<xul::StripTraceEvent> traceChurn(unsigned threadCount)
+{
+  xul::DynamicStripool pool{{.stripSize = 4096, .stripCount = 4096}};
+  std::stringstream trace;
+  {
+    xul::TracingStripool tracing{pool, trace};
+    std::latch start{threadCount};
+    std::vector<std::thread> threads;
+    for ( unsigned threadId = 0; threadId < threadCount; ++threadId ) {
+      threads.push_back(std::thread{[threadId, &start, &tracing]{
+        Rng rng{threadId + 1};
+        std::array<char*, 32> window{};
+        start.arrive_and_wait();
+        for ( unsigned op = 0; op < 20'000; ++op ) {
+          char*& acq = window[rng.bounded(window.size())];
+          if ( acq ) {
+            tracing.release(acq);
+          }
+          acq = tracing.acquire(16 + rng.bounded(241));
+        }
+        for ( char* acq : window ) {
+          if ( acq ) {
+            tracing.release(acq);
+          }
+        }
+      }});
+    }
+    for ( auto& thread : threads ) {
+      thread.join();
+    }
+  }
+  return xul::read_strip_trace(trace);
+}
+
+/// Replays a recorded trace against candidate configurations, as would be
+/// done with a trace from production to size a pool.
+const auto bench1 = []{
+  const auto events = traceChurn(4);
+
+  struct Candidate { std::size_t stripSize, stripCount; };
+  std::printf("\n| strip size | strips | failure rate | peak strips in use | replay ms\n|--:|--:|--:|--:|--:\n");
+  for ( const Candidate candidate : std::initializer_list<Candidate>{
+          {256, 64}, {256, 128}, {256, 256}, {1024, 32}, {1024, 64}, {4096, 16}, {4096, 32}} ) {
+    xul::DynamicStripool pool{{.stripSize = candidate.stripSize, .stripCount = candidate.stripCount}};
+    const auto replay = xul::replay_strip_trace(events, pool);
+    std::printf("| %zu | %zu | %.4f | %zu | %.2f\n",
+      candidate.stripSize, candidate.stripCount, replay.failure_rate(), replay.peakStripsInUse,
+      std::chrono::duration<double, std::milli>(replay.duration).count());
+  }
+
+  // Replaying is itself benchmarked against one configuration, to show what
+  // trying a candidate costs.
+  Bench bench;
+  xul::DynamicStripool pool{{.stripSize = 1024, .stripCount = 64}};
+  bench.title("Stripool trace replay").unit("event").batch(events.size()).epochs(5).epochIterations(1)
+    .run("1024 x 64", [&]{ doNotOptimizeAway(xul::replay_strip_trace(events, pool)); });
+  return bench;
+}();
+
+}
@@ -1,12 +1,466 @@
 #ifndef _xul_stripool_hpp_
 #define _xul_stripool_hpp_
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <concepts>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#endif
 
 namespace xul {
 
+/// Selects which strip an acquisition starts searching from.
+enum class StripAffinity
+{
+  /// Every thread starts at the strip the pool last acquired from. This keeps
+  /// strips densely used, but all threads contend on the same strip header.
+  shared,
+  /// Each thread is given a slot index the first time it acquires from any
+  /// pool, and starts at the strip that slot maps to, only spilling over to
+  /// the following strips when its own strip is full. Threads then mostly
+  /// contend with the other threads sharing their strip.
+  thread,
+};
+
+/// Selects where strip headers live in relation to the strips themselves.
+enum class StripLayout
+{
+  /// Each strip's header sits directly in front of its first acquisition.
+  /// This is the most compact, but the header shares its cache line with
+  /// acquired memory, and with the neighbouring strips' headers when strips
+  /// are small.
+  interleaved,
+  /// Headers are kept in their own array, apart from the strips, with each
+  /// header occupying its own cache line.
+  isolated,
+};
+
+/// Bookkeeping policy for a stripool, selecting the atomic *word_type_* each
+/// strip uses to keep track of its acquisitions, and how the word is split.
+/// The upper *count_bits_* count the acquisitions in the strip, and the
+/// remaining lower bits hold the strip's head. For example:
+/// - `StripBookkeeping<std::uint32_t, 8>` allows 255 acquisitions in strips of
+///   up to 16MiB, and is the default.
+/// - `StripBookkeeping<std::uint32_t, 16>` allows 65535 acquisitions in strips
+///   of up to 64KiB.
+/// - `StripBookkeeping<std::uint64_t, 32>` allows 2^32-1 acquisitions in
+///   strips of up to 4GiB.
+template <std::unsigned_integral word_type_, unsigned count_bits_>
+struct StripBookkeeping
+{
+  using word_type = word_type_;
+
+  static constexpr unsigned count_bits = count_bits_;
+  static constexpr unsigned head_bits = sizeof(word_type) * 8 - count_bits;
+
+  static_assert(count_bits > 0 && head_bits > 0);
+  static_assert(std::atomic<word_type>::is_always_lock_free);
+
+  // The allocation count is stored in the upper bits, so a mask and shift
+  // are handy to have, as well as a constant for incrementing the count.
+  static constexpr unsigned count_shift = head_bits;
+  static constexpr word_type count_inc = word_type{1} << count_shift;
+  static constexpr word_type count_mask = static_cast<word_type>(~(count_inc - 1));
+
+  // The head is stored in the lower bits, and we only need a mask for our
+  // operations on it.
+  static constexpr word_type head_mask = count_inc - 1;
+
+  /// Maximum acquisitions that a single strip can hold at once.
+  static constexpr std::size_t max_count = count_mask >> count_shift;
+  /// Maximum size of a strip, including its bookkeeping.
+  static constexpr std::size_t max_strip_size = std::size_t{head_mask} + 1;
+};
+
+/// Slot index of the calling thread, handed out in order of each thread's
+/// first use, and shared by all stripools.
+inline std::size_t stripool_thread_slot() noexcept
+{
+  static std::atomic<std::size_t> nextSlot{0};
+  thread_local const std::size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+/// Stats policy for a stripool that records nothing, and costs nothing.
+struct NoStripStats
+{
+  static constexpr bool enabled = false;
+};
+
+/// Stats policy for a stripool that records how it is used, to help with
+/// sizing it. Counters are sharded into *shard_count_* cache lines, with each
+/// thread recording to the shard of its slot, so that threads seldom contend
+/// on a counter. Taking a snapshot sums the shards, so is cheap enough to
+/// scrape periodically, but is not an atomic view of all the counters.
+template <std::size_t shard_count_ = 16>
+class StripStats
+{
+public:
+  static constexpr bool enabled = true;
+
+  struct Snapshot
+  {
+    /// Acquisitions made.
+    std::uint64_t acquires = 0;
+    /// Attempts to acquire that found no strip with room.
+    std::uint64_t failedAcquires = 0;
+    /// Compare-exchanges made on strip headers, when acquiring and releasing.
+    std::uint64_t casAttempts = 0;
+    /// Compare-exchanges that had to be retried because another thread
+    /// changed the strip first.
+    std::uint64_t casRetries = 0;
+    /// Strips looked at by attempts to acquire, successful or not.
+    std::uint64_t stripsScanned = 0;
+    /// Strips reset by releasing their last acquisition.
+    std::uint64_t stripResets = 0;
+    /// Releases of a strip's last acquisition, whose space was given back by
+    /// moving the strip's head back over it.
+    std::uint64_t headRollbacks = 0;
+    /// The most acquisitions any one strip has held at once.
+    std::uint64_t peakStripCount = 0;
+  };
+
+  Snapshot snapshot() const noexcept {
+    Snapshot snapshot;
+    for ( const Shard& shard : shards_ ) {
+      snapshot.acquires += shard.acquires.load(std::memory_order_relaxed);
+      snapshot.failedAcquires += shard.failedAcquires.load(std::memory_order_relaxed);
+      snapshot.casAttempts += shard.casAttempts.load(std::memory_order_relaxed);
+      snapshot.casRetries += shard.casRetries.load(std::memory_order_relaxed);
+      snapshot.stripsScanned += shard.stripsScanned.load(std::memory_order_relaxed);
+      snapshot.stripResets += shard.stripResets.load(std::memory_order_relaxed);
+      snapshot.headRollbacks += shard.headRollbacks.load(std::memory_order_relaxed);
+      snapshot.peakStripCount = std::max<std::uint64_t>(
+        snapshot.peakStripCount,
+        shard.peakStripCount.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+  }
+
+  /// Record an attempt to acquire that made *acquisitions*, or none if it
+  /// failed, having scanned *scanned* strips and made *cas* compare-exchanges,
+  /// all but the last of which were retried if it succeeded. The strip
+  /// acquired from is left with *count* acquisitions.
+  void acquired(std::size_t acquisitions, std::size_t scanned, std::size_t cas, std::size_t count) noexcept {
+    Shard& shard = this->shard();
+    const std::size_t retries = acquisitions ? cas - 1 : cas;
+    if ( acquisitions ) {
+      shard.acquires.fetch_add(acquisitions, std::memory_order_relaxed);
+      std::uint64_t peak = shard.peakStripCount.load(std::memory_order_relaxed);
+      while ( count > peak && !shard.peakStripCount.compare_exchange_weak(peak, count, std::memory_order_relaxed) ) {
+      }
+    } else {
+      shard.failedAcquires.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.casAttempts.fetch_add(cas, std::memory_order_relaxed);
+    if ( retries ) {
+      shard.casRetries.fetch_add(retries, std::memory_order_relaxed);
+    }
+    shard.stripsScanned.fetch_add(scanned, std::memory_order_relaxed);
+  }
+
+  /// Record a release that made *cas* compare-exchanges, all but the last of
+  /// which were retried, and whether it *reset* the strip, or *rolledBack* its
+  /// head.
+  void released(std::size_t cas, bool reset, bool rolledBack) noexcept {
+    Shard& shard = this->shard();
+    shard.casAttempts.fetch_add(cas, std::memory_order_relaxed);
+    if ( cas > 1 ) {
+      shard.casRetries.fetch_add(cas - 1, std::memory_order_relaxed);
+    }
+    if ( reset ) {
+      shard.stripResets.fetch_add(1, std::memory_order_relaxed);
+    }
+    if ( rolledBack ) {
+      shard.headRollbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  struct alignas(64) Shard
+  {
+    std::atomic<std::uint64_t> acquires{0};
+    std::atomic<std::uint64_t> failedAcquires{0};
+    std::atomic<std::uint64_t> casAttempts{0};
+    std::atomic<std::uint64_t> casRetries{0};
+    std::atomic<std::uint64_t> stripsScanned{0};
+    std::atomic<std::uint64_t> stripResets{0};
+    std::atomic<std::uint64_t> headRollbacks{0};
+    std::atomic<std::uint64_t> peakStripCount{0};
+  };
+
+  Shard& shard() noexcept { return shards_[stripool_thread_slot() % shard_count_]; }
+
+  std::array<Shard, shard_count_> shards_;
+};
+
+/// Occupancy policy for a stripool that keeps no track of which strips have
+/// room, so acquiring looks at each strip in turn until one does.
+struct NoStripOccupancy
+{
+  static constexpr bool enabled = false;
+
+  constexpr NoStripOccupancy() noexcept = default;
+  constexpr NoStripOccupancy(std::size_t, const void*, std::size_t) noexcept {}
+};
+
+/// Occupancy policy for a stripool that keeps a bitmap of the strips that may
+/// have room, so that acquiring skips over strips known to be full 64 at a
+/// time, rather than loading each of their headers in turn. This keeps the
+/// cost of acquiring flat for large pools that are mostly full, at the cost
+/// of an atomic update of the bitmap whenever a strip fills or gives back
+/// space.
+///
+/// A strip's bit is cleared when it has no room for an acquisition, and set
+/// again when it gives back space, by being reset, or having its last
+/// acquisition rolled back or shrunk. A strip without room for a large
+/// acquisition may still have room for a small one, so should no strip be
+/// thought to have room, strips are looked at in turn just the same, and
+/// acquiring only fails having looked at them all.
+class StripOccupancy
+{
+public:
+  static constexpr bool enabled = true;
+  static constexpr std::size_t npos = SIZE_MAX;
+
+  /// Bitmap of *stripCount* strips, all thought to have room, whose headers
+  /// are every *hdrStride* bytes from *hdrMem*.
+  StripOccupancy(std::size_t stripCount, const void* hdrMem, std::size_t hdrStride)
+    : stripCount_{stripCount}
+    , wordCount_{(stripCount + word_bits - 1) / word_bits}
+    , words_{std::make_unique<std::atomic<std::uint64_t>[]>(std::max<std::size_t>(wordCount_, 1))}
+    , hdrMem_{static_cast<const char*>(hdrMem)}
+    , hdrStride_{hdrStride}
+  {
+    for ( std::size_t w = 0; w < wordCount_; ++w ) {
+      const std::size_t bits = std::min(stripCount_ - w * word_bits, word_bits);
+      words_[w].store(bits == word_bits ? ~std::uint64_t{0} : (std::uint64_t{1} << bits) - 1, std::memory_order_relaxed);
+    }
+  }
+
+  /// The first strip from the *from*th on, wrapping around, that may have
+  /// room, or npos if none are thought to.
+  std::size_t next(std::size_t from) const noexcept {
+    std::size_t w = from / word_bits;
+    std::uint64_t bits = words_[w].load(std::memory_order_relaxed) & (~std::uint64_t{0} << (from % word_bits));
+    // The first word is looked at again last, for the strips before *from*.
+    for ( std::size_t n = 0; n <= wordCount_; ++n ) {
+      if ( bits ) {
+        return w * word_bits + std::countr_zero(bits);
+      }
+      w = w + 1 == wordCount_ ? 0 : w + 1;
+      bits = words_[w].load(std::memory_order_relaxed);
+    }
+    return npos;
+  }
+
+  /// Note that the *i*th strip has no room. Acquiring pairs with the release
+  /// of a strip that gave back space in the meantime, so that the caller can
+  /// load the strip's header again to check.
+  void full(std::size_t i) noexcept {
+    words_[i / word_bits].fetch_and(~bit(i), std::memory_order_acq_rel);
+  }
+
+  /// Note that the *i*th strip has room, having been found to, rather than
+  /// given space back, so nothing need be published.
+  void has_room(std::size_t i) noexcept {
+    auto& word = words_[i / word_bits];
+    if ( !(word.load(std::memory_order_relaxed) & bit(i)) ) {
+      word.fetch_or(bit(i), std::memory_order_relaxed);
+    }
+  }
+
+  /// Note that the strip with the header at *hdr* has given back space.
+  void gave_back(const void* hdr) noexcept {
+    const std::size_t i = static_cast<std::size_t>(static_cast<const char*>(hdr) - hdrMem_) / hdrStride_;
+    words_[i / word_bits].fetch_or(bit(i), std::memory_order_release);
+  }
+
+private:
+  static constexpr std::size_t word_bits = 64;
+
+  static constexpr std::uint64_t bit(std::size_t i) noexcept {
+    return std::uint64_t{1} << (i % word_bits);
+  }
+
+  const std::size_t stripCount_;
+  const std::size_t wordCount_;
+  const std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+  const char* const hdrMem_;
+  const std::size_t hdrStride_;
+};
+
+/// An acquisition waiting for a strip to reset, such as a suspended coroutine,
+/// as held in the StripParking's list of waiters.
+struct StripWaiter
+{
+  /// Try to acquire again for the *waiter*, resuming it if successful, after
+  /// which the waiter must not be touched, as it may no longer exist.
+  /// Returns whether the waiter was resumed.
+  bool (*retry)(StripWaiter& waiter) noexcept;
+  StripWaiter* next = nullptr;
+};
+
+/// Where threads waiting for a strip of a pool to reset are parked, and where
+/// waiters such as suspended coroutines are listed. Each pool has its own,
+/// which releases find through the pool their strip points back to, so
+/// resets only wake the waiters of their own pool.
+///
+/// Listed waiters are retried by whichever thread resets a strip, with
+/// concurrent resets combined, so that only one thread retries the list at a
+/// time, and goes over it again for resets that happen meanwhile. The list
+/// itself is a lock free stack that is taken whole to be retried.
+class StripParking
+{
+public:
+  /// Park the calling thread until a strip is reset, given the *resets* seen
+  /// before last trying to acquire, or until the *deadline* if there is one.
+  /// May return spuriously.
+  void park(std::uint32_t resets, const std::chrono::steady_clock::time_point* deadline) noexcept {
+#ifdef __linux__
+    timespec timeout{};
+    if ( deadline ) {
+      const auto remaining = std::chrono::ceil<std::chrono::nanoseconds>(
+        *deadline - std::chrono::steady_clock::now());
+      if ( remaining.count() <= 0 ) {
+        return;
+      }
+      timeout.tv_sec = remaining.count() / 1'000'000'000;
+      timeout.tv_nsec = remaining.count() % 1'000'000'000;
+    }
+    ::syscall(SYS_futex, &resets_, FUTEX_WAIT_PRIVATE, resets, deadline ? &timeout : nullptr, nullptr, 0);
+#else
+    if ( deadline ) {
+      // Without a timed wait, sleep in short steps until the deadline.
+      if ( resets_.load(std::memory_order_acquire) == resets ) {
+        std::this_thread::sleep_until(std::min(*deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds{1}));
+      }
+    } else {
+      resets_.wait(resets, std::memory_order_acquire);
+    }
+#endif
+  }
+
+  /// Register the calling thread as waiting, before it first reads resets().
+  void enter() noexcept {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  void leave() noexcept {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// The number of strip resets that have woken waiters, to be read before
+  /// attempting to acquire, then passed on to park().
+  std::uint32_t resets() noexcept {
+    // Pairs with the fence in strip_reset(), so that either the waiter is
+    // seen, or the reset is seen by the attempt to acquire that follows.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return resets_.load(std::memory_order_acquire);
+  }
+
+  /// List the *waiter*, which has failed to acquire, to be retried when a
+  /// strip is reset. The waiter is retried straight away, for any reset since
+  /// it last tried, so may have been resumed by the time this returns.
+  void list(StripWaiter& waiter) noexcept {
+    listed_.fetch_add(1, std::memory_order_seq_cst);
+    push(waiter);
+    retryListed();
+  }
+
+  /// Wake every parked thread, and retry every listed waiter, if there are
+  /// any, as a strip has been reset, or had space given back to it. When none
+  /// are waiting, this costs a fence and a load or two from the same cache
+  /// line.
+  void strip_reset() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if ( waiters_.load(std::memory_order_relaxed) != 0 ) {
+      resets_.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+      ::syscall(SYS_futex, &resets_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+      resets_.notify_all();
+#endif
+    }
+    if ( listed_.load(std::memory_order_relaxed) != 0 ) {
+      retryListed();
+    }
+  }
+
+private:
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+  void push(StripWaiter& waiter) noexcept {
+    waiter.next = listHead_.load(std::memory_order_relaxed);
+    while ( !listHead_.compare_exchange_weak(
+        waiter.next,
+        &waiter,
+        std::memory_order_release,
+        std::memory_order_relaxed) ) {
+    }
+  }
+
+  /// Retry every listed waiter, or if another thread is already doing so,
+  /// have it go over the list again.
+  void retryListed() noexcept {
+    if ( retries_.fetch_add(1, std::memory_order_acq_rel) != 0 ) {
+      return;
+    }
+    std::uint32_t retries = 1;
+    do {
+      // Pairs with the fence in strip_reset(), so that either a listed waiter
+      // is seen by the reset, or the reset is seen by the retry.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      StripWaiter* waiter = listHead_.exchange(nullptr, std::memory_order_acquire);
+      while ( waiter ) {
+        StripWaiter* next = waiter->next;
+        // Waiters are counted until they are resumed, rather than while they
+        // are on the list, so that resets that happen while the list is
+        // being retried still lead to it being retried again.
+        if ( waiter->retry(*waiter) ) {
+          listed_.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+          push(*waiter);
+        }
+        waiter = next;
+      }
+      retries = retries_.fetch_sub(retries, std::memory_order_acq_rel) - retries;
+    } while ( retries != 0 );
+  }
+
+  // The reset count is only written when there are waiters, so is kept apart
+  // from the waiter counts that every reset reads.
+  alignas(64) std::atomic<std::uint32_t> resets_{0};
+  alignas(64) std::atomic<std::uint32_t> waiters_{0};
+  std::atomic<std::uint32_t> listed_{0};
+  alignas(64) std::atomic<StripWaiter*> listHead_{nullptr};
+  std::atomic<std::uint32_t> retries_{0};
+};
+
+/// Resumes coroutines inline, on the thread that acquired for them.
+struct InlineResumption
+{
+  void operator()(std::coroutine_handle<> handle) const { handle.resume(); }
+};
+
 /// Memory pool that uses "strips" of memory that it cycles through when one
 /// strip cannot provide the memory requested. Each strip only keeps track of:
 /// - Number of active acquisitions
@@ -15,186 +469,849 @@ namespace xul {
 /// When acquisitions are released, only the active acquisition count is
 /// decremented, and the head remains untouched. But, if the acquisition count
 /// becomes 0, the head is reset, making the entirety of the strip available
-/// again.
+/// again. And if the acquisition is the last from the strip, so ends at the
+/// head, the head is moved back over it, so that acquisitions and releases
+/// in stack order reuse the same space.
 /// This scheme makes releases pretty much O(1), and acquisitions are at worst
 /// O(n), where n is the number of strips, where the operation is an atomic check
 /// of the strip's head to see if the acquistion will fit.
 ///
-/// Concurrent acquisition and releasing is supported, and is lock free as long
-/// as std::atomic_uint32_t is atomic.
+/// Concurrent acquisition and releasing is supported, and is lock free, as the
+/// bookkeeping policy only allows for always lock free atomic types.
 ///
 /// The intended use case for this pool is to acquire memory for ephemeral
 /// objects. The strip size will be determined by the largest object. The number
 /// of strips is determined by how many objects are expected to be allocated
-/// at once. This is typically determined through empirical measumrent. Failure
-/// to acquire a resource is not an error.
+/// at once. This is typically determined through empirical measumrent, such
+/// as by replaying a trace of the acquisitions with stripool_trace.hpp.
+/// Failure to acquire a resource is not an error.
+///
+/// # Strip affinity
+///
+/// By default, all threads start their search from the same strip, which
+/// under many concurrent threads makes that strip's header a hot spot. Pools
+/// can be constructed with StripAffinity::thread so that each thread prefers
+/// a strip of its own. Pools with fewer strips than there are threads will
+/// still have threads sharing strips.
+///
+/// # Strip layout
+///
+/// Strip headers are normally interleaved with the strips, which for small
+/// strips packs several headers into each cache line, and puts acquired memory
+/// on the same cache line as a header. Writes to acquired memory then cause
+/// false sharing with threads acquiring from and releasing to the neighbouring
+/// strips. Pools can instead keep their headers isolated, in an array of
+/// cache line sized headers, at the cost of a cache line per strip.
+///
+/// # Waiting for memory
+///
+/// Rather than spinning on acquire() until memory is released, callers can
+/// use acquire_wait() or acquire_for() to park until a strip is reset. These
+/// first try to acquire just as acquire() does, so are no costlier when the
+/// pool has room. Coroutines can likewise `co_await` async_acquire(), which
+/// suspends them until a strip is reset, and resumes them from the release
+/// that reset it. Each pool has its own waiters, which releases find through
+/// the strip they reset, and only check for when they reset one.
+///
+/// # Resizing in place
+///
+/// The last acquisition from a strip is followed by the strip's head, so it
+/// can be grown with try_extend(), or shrunk with shrink(), by just moving the
+/// head. Records whose size isn't known up front can then be built up in the
+/// acquisition, rather than acquiring for the worst case.
+///
+/// # Stats
+///
+/// Pools record nothing by default. Pools with the StripStats *Stats* policy
+/// record their acquisitions, releases and contention, which can be read with
+/// stats(), to help with sizing the pool. Releases record to the stats of the
+/// pool their strip points back to, so recording takes no room in the strips.
+/// Acquisitions from such pools must only be released through pools with the
+/// same *Stats* policy.
+///
+/// # Occupancy
+///
+/// By default, acquiring looks at each strip in turn from where it starts
+/// until one has room, which for a large pool that is mostly full is a cache
+/// miss for every full strip. Pools with the StripOccupancy *Occupancy* policy
+/// keep a bitmap of the strips that may have room, and skip to them. As with
+/// stats, releases find the bitmap through their strip, to set the strip's
+/// bit when it gives back space, and acquisitions must only be released
+/// through pools with the same *Occupancy* policy.
 ///
 /// # Limitations
 ///
-/// An atomic uint32_t bitfield is used at the start of each strip to keep track
-/// of the number of allocations in the strip, and where the next allocation in
-/// the strip should occur. This current scheme imposes the following restrictions:
-/// - The maximum strip size is 16'777'216 (2^24) - sizeof(std::max_align_t),
-///   as the lower 24-bits are used to track where the next acquisition can
-///   occur, and always acounts for bookkeeping block (the sizeof(std::max_align_t)).
-/// - Maximum allocations per strip is 255 (2^8-1), as the upper 8 bits count
-///   the number of allocations in the strip.
-///
-/// # Future Improvements
-///
-/// These are things that should probably be tackled:
-/// - Provide more configuration:
-///   - Atmoic type to use for bookkeeping
-///   - Number of bits for counter / head, allowing more smaller allocations
-///     per strip, or fewer larger allocations per strip.
-struct Stripool
+/// An atomic bitfield, as described by the *Bookkeeping* policy, is used for
+/// each strip to keep track of the number of allocations in the strip, and
+/// where the next allocation in the strip should occur. This imposes the
+/// following restrictions:
+/// - The maximum strip size is Bookkeeping::max_strip_size, which includes
+///   the strip's header, as the head always accounts for it.
+/// - Maximum allocations per strip is Bookkeeping::max_count. Once a strip
+///   holds that many, it is treated as full.
+///
+/// The default, Stripool, uses a u32 with 8 bits for the count, limiting
+/// strips to 255 allocations and 16MiB.
+template <
+  typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>,
+  typename Stats = NoStripStats,
+  typename Occupancy = NoStripOccupancy>
+struct BasicStripool
 {
+  using bookkeeping = Bookkeeping;
+  using stats_policy = Stats;
+  using occupancy_policy = Occupancy;
+
+  /// Snapshot of the pool's stats, for pools that record them.
+  [[nodiscard]] auto stats() const noexcept requires Stats::enabled {
+    return stats_.snapshot();
+  }
+
   [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    // Every acquisition is preceeded by the pointer back to its strip, and
+    // is padded out so that the next acquisition's pointer is aligned.
+    requested += sizeof(StripPtr);
+    requested = (requested + alignof(StripPtr) - 1) & ~(alignof(StripPtr) - 1);
+    const Claim claimed = claim(requested);
+    if ( !claimed.mem ) {
+      return nullptr;
+    }
+    return stamp(claimed.mem, claimed.strip, claimed.begin, claimed.head + requested);
+  }
 
-    // We start at the last accessed strip, and keep track of the number of
-    // strips interrogated, giving up if we interrogate all strips.
-    std::size_t stripIdx = currentStrip_.load(std::memory_order_relaxed);
-    size_t interrogated = 0;
+  /// The largest alignment that acquisitions can ask for, which is the
+  /// assumed page size.
+  static constexpr std::size_t max_alignment = 4096;
 
+  /// Acquire memory aligned to *alignment*, which must be a power of two no
+  /// larger than max_alignment, or nullptr is returned. Acquisitions are
+  /// always max aligned, and any further alignment is made by padding in
+  /// front of the acquisition, only as much as needed for where it lands in
+  /// the strip. Strips must have room for the padding as well as the
+  /// acquisition, which can be up to *alignment* - alignof(std::max_align_t)
+  /// bytes.
+  [[nodiscard]] char* acquire(std::uint32_t requested, std::size_t alignment) noexcept {
+    if ( alignment <= alignof(std::max_align_t) ) {
+      return std::has_single_bit(alignment) ? acquire(requested) : nullptr;
+    }
+    if ( !std::has_single_bit(alignment) || alignment > max_alignment ) {
+      return nullptr;
+    }
     requested += sizeof(StripPtr);
+    requested = (requested + alignof(StripPtr) - 1) & ~(alignof(StripPtr) - 1);
+    const Claim claimed = claim(requested, 1, alignment);
+    if ( !claimed.mem ) {
+      return nullptr;
+    }
+    return stamp(claimed.mem, claimed.strip, claimed.begin, claimed.head + requested);
+  }
+
+  /// Whether *mem* lies within the pool's strips, as anything acquired from
+  /// the pool does. This is only a check of the address range, so is cheap
+  /// enough to tell acquisitions apart from memory allocated elsewhere.
+  [[nodiscard]] bool owns(const void* mem) const noexcept {
+    const auto addr = reinterpret_cast<std::uintptr_t>(mem);
+    const auto start = reinterpret_cast<std::uintptr_t>(stripMem_);
+    return addr >= start && addr - start < stripCount_ * stripStride_;
+  }
+
+  std::size_t strip_count() const noexcept { return stripCount_; }
+
+  /// Index of the strip that *mem*, acquired from the pool, lies in, for
+  /// looking into how acquisitions are spread over the strips.
+  [[nodiscard]] std::size_t strip_index(const void* mem) const noexcept {
+    // An empty acquisition can end its strip, but its StripPtr is within it.
+    const auto addr = reinterpret_cast<std::uintptr_t>(mem) - sizeof(StripPtr);
+    return (addr - reinterpret_cast<std::uintptr_t>(stripMem_)) / stripStride_;
+  }
+
+  static void release(char* mem) {
+    // Preceeding the *mem* is a pointer the strip it was acquired from.
+    StripPtr* ptr = reinterpret_cast<StripPtr*>(mem - sizeof(StripPtr));
+    releaseStrip(ptr->strip, first_head, 1, ptr->begin, ptr->end);
+  }
+
+  /// Grow the acquisition at *mem* from *oldSize* to *newSize* bytes in
+  /// place, which can only be done while it is the last acquisition from its
+  /// strip, and the strip has room. Returns false, leaving the acquisition as
+  /// it was, if it can't be grown, in which case the caller must make do, or
+  /// acquire anew and copy. Growing to a smaller size shrinks it, as shrink().
+  /// The *oldSize* must be the size the acquisition was acquired with, or
+  /// last resized to, and the acquisition must be from this pool.
+  [[nodiscard]] bool try_extend(char* mem, std::uint32_t oldSize, std::uint32_t newSize) noexcept {
+    if ( newSize <= oldSize ) {
+      shrink(mem, oldSize, newSize);
+      return true;
+    }
+    StripPtr* ptr = reinterpret_cast<StripPtr*>(mem - sizeof(StripPtr));
+    const std::size_t end = ptr->end;
+    const std::size_t newEnd = end - paddedSize(oldSize) + paddedSize(newSize);
+    if ( end == 0 || newEnd > stripSize_ || newEnd > UINT32_MAX ) {
+      return false;
+    }
+    word_type countAndHead = ptr->strip->countAndHead.load(std::memory_order_relaxed);
+    while ( (countAndHead & head_mask_) == end ) {
+      // Acquiring pairs with the releases of whatever was last acquired past
+      // the acquisition, just as claiming does.
+      if ( ptr->strip->countAndHead.compare_exchange_weak(
+          countAndHead,
+          static_cast<word_type>((countAndHead & count_mask_) | newEnd),
+          std::memory_order_acq_rel,
+          std::memory_order_relaxed) ) {
+        ptr->end = static_cast<std::uint32_t>(newEnd);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Shrink the acquisition at *mem* from *oldSize* to *newSize* bytes, giving
+  /// the space back to its strip if it is still the strip's last acquisition.
+  /// Otherwise the space is given back when the strip is reset, as with the
+  /// rest of the acquisition. The *oldSize* is as for try_extend().
+  static void shrink(char* mem, std::uint32_t oldSize, std::uint32_t newSize) noexcept {
+    StripPtr* ptr = reinterpret_cast<StripPtr*>(mem - sizeof(StripPtr));
+    const std::size_t end = ptr->end;
+    const std::size_t newEnd = end - paddedSize(oldSize) + paddedSize(newSize);
+    if ( end == 0 || newEnd >= end ) {
+      return;
+    }
+    word_type countAndHead = ptr->strip->countAndHead.load(std::memory_order_relaxed);
+    while ( (countAndHead & head_mask_) == end ) {
+      if ( ptr->strip->countAndHead.compare_exchange_weak(
+          countAndHead,
+          static_cast<word_type>((countAndHead & count_mask_) | newEnd),
+          std::memory_order_release,
+          std::memory_order_relaxed) ) {
+        ptr->end = static_cast<std::uint32_t>(newEnd);
+        if constexpr ( Occupancy::enabled ) {
+          ptr->strip->pool->occupancy_.gave_back(ptr->strip);
+        }
+        if ( ptr->strip->pool ) {
+          ptr->strip->pool->parking_.strip_reset();
+        }
+        return;
+      }
+    }
+  }
+
+  /// Acquire memory for each of the *sizes* into the corresponding element of
+  /// *out*, which must be at least as large. When the whole batch fits in one
+  /// strip, it is claimed from the strip at once, which is a single atomic
+  /// exchange, rather than one per acquisition. Otherwise, acquisitions are
+  /// made one at a time. Either every acquisition is made, or none are, and
+  /// false is returned.
+  [[nodiscard]] bool acquire_bulk(std::span<const std::uint32_t> sizes, std::span<char*> out) noexcept {
+    std::size_t total = 0;
+    for ( const auto size : sizes ) {
+      total += paddedSize(size);
+    }
+    if ( sizes.empty() ) {
+      return true;
+    }
+    if ( sizes.size() <= Bookkeeping::max_count && total <= std::min<std::size_t>(stripSize_, UINT32_MAX) ) {
+      if ( const Claim claimed = claim(static_cast<std::uint32_t>(total), sizes.size()); claimed.mem ) {
+        char* mem = claimed.mem;
+        std::size_t head = claimed.head;
+        for ( std::size_t i = 0; i < sizes.size(); ++i ) {
+          out[i] = stamp(mem, claimed.strip, head, head + paddedSize(sizes[i]));
+          head += paddedSize(sizes[i]);
+          mem += paddedSize(sizes[i]);
+        }
+        return true;
+      }
+    }
+    for ( std::size_t i = 0; i < sizes.size(); ++i ) {
+      out[i] = acquire(sizes[i]);
+      if ( !out[i] ) {
+        release_bulk(out.first(i));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Release each of the acquisitions in *mems*, which can come from any
+  /// strips of any pools with the same bookkeeping. Acquisitions are grouped
+  /// by strip, so that each strip's count is decremented at once, which is
+  /// cheapest when acquisitions from the same strip are together.
+  static void release_bulk(std::span<char* const> mems) noexcept {
+    for ( std::size_t i = 0; i < mems.size(); ++i ) {
+      StripHdr* strip = stripOf(mems[i]);
+      // Strips are released when first found, along with all the later
+      // acquisitions from them, which is quadratic, but over small batches,
+      // and saves keeping track of them elsewhere.
+      if ( i > 0 && stripOf(mems[i - 1]) == strip ) {
+        continue;
+      }
+      bool released = false;
+      for ( std::size_t j = 0; j < i && !released; ++j ) {
+        released = stripOf(mems[j]) == strip;
+      }
+      if ( released ) {
+        continue;
+      }
+      std::size_t count = 1;
+      for ( std::size_t j = i + 1; j < mems.size(); ++j ) {
+        count += stripOf(mems[j]) == strip;
+      }
+      releaseStrip(strip, first_head, count);
+    }
+  }
+
+  /// Acquire, parking the calling thread until a strip is reset whenever the
+  /// pool has no room. Never returns nullptr, so waits forever for a request
+  /// that no strip can hold.
+  [[nodiscard]] char* acquire_wait(std::uint32_t requested) noexcept {
+    if ( char* acq = acquire(requested) ) {
+      return acq;
+    }
+    return acquireParked(requested, nullptr);
+  }
+
+  /// Acquire, parking the calling thread until a strip is reset whenever the
+  /// pool has no room, for up to the *timeout*. Returns nullptr on timing out.
+  template <typename Rep, typename Period>
+  [[nodiscard]] char* acquire_for(std::uint32_t requested, std::chrono::duration<Rep, Period> timeout) noexcept {
+    if ( char* acq = acquire(requested) ) {
+      return acq;
+    }
+    const auto deadline = std::chrono::steady_clock::now()
+      + std::chrono::ceil<std::chrono::steady_clock::duration>(timeout);
+    return acquireParked(requested, &deadline);
+  }
+
+  /// Awaitable acquisition, as returned by async_acquire().
+  template <typename Executor>
+  class AsyncAcquire : private StripWaiter
+  {
+  public:
+    AsyncAcquire(BasicStripool& pool, std::uint32_t requested, Executor executor)
+      : StripWaiter{&retry}
+      , pool_{pool}
+      , requested_{requested}
+      , executor_{std::move(executor)}
+    {}
+
+    bool await_ready() noexcept {
+      acq_ = pool_.acquire(requested_);
+      return acq_;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      handle_ = handle;
+      pool_.parking_.list(*this);
+    }
+
+    [[nodiscard]] char* await_resume() const noexcept { return acq_; }
+
+  private:
+    static bool retry(StripWaiter& waiter) noexcept {
+      auto& self = static_cast<AsyncAcquire&>(waiter);
+      self.acq_ = self.pool_.acquire(self.requested_);
+      if ( !self.acq_ ) {
+        return false;
+      }
+      // The awaitable lives in the coroutine's frame, which may be gone as
+      // soon as the coroutine is resumed, including the executor itself.
+      auto executor = self.executor_;
+      executor(self.handle_);
+      return true;
+    }
+
+    BasicStripool& pool_;
+    const std::uint32_t requested_;
+    [[no_unique_address]] Executor executor_;
+    char* acq_ = nullptr;
+    std::coroutine_handle<> handle_;
+  };
+
+  /// Acquire from a coroutine, with `co_await pool.async_acquire(requested)`,
+  /// which suspends the coroutine whenever the pool has no room, until a
+  /// strip is reset. The coroutine is then resumed by the *executor*, which
+  /// is called with the coroutine's handle, from within the release that
+  /// reset the strip. By default, the coroutine is resumed there and then, so
+  /// the releasing thread carries on with it until it next suspends. An
+  /// executor that hands the coroutine off to be resumed elsewhere avoids
+  /// that. Executors are copied for each resumption, so should be cheap to
+  /// copy.
+  /// Never completes with nullptr, so waits forever for a request that no
+  /// strip can hold.
+  template <typename Executor = InlineResumption>
+  [[nodiscard]] AsyncAcquire<Executor> async_acquire(std::uint32_t requested, Executor executor = {}) noexcept {
+    return {*this, requested, std::move(executor)};
+  }
+
+protected:
+  using word_type = typename Bookkeeping::word_type;
+
+  /// Each strip consists of a header with the count and head atomic, and is
+  /// padded out to the first acquisition. The header type is made available
+  /// to subclasses, as they must ensure that the strip pointer provided at
+  /// construction accounts for the the header size.
+  /// The header is at least aligned as a pointer, since the StripPtr that
+  /// follows it is aligned as such, since that's its first member.
+  /// Each strip points back to its pool, unless it has been detached from it,
+  /// for releases to wake the pool's waiters, and update its stats and
+  /// occupancy, should it keep them.
+  struct alignas(std::max(alignof(std::atomic<word_type>), alignof(void*))) StripHdr {
+    std::atomic<word_type> countAndHead;
+    BasicStripool* pool;
+  };
+
+public:
+  /// Space reserved in a strip, for acquisitions to be made from by a single
+  /// thread, without touching the strip's header, as by a StripMagazine.
+  struct Reservation {
+    StripHdr* strip = nullptr;
+    /// Where the next acquisition's StripPtr goes, and the end of the space.
+    char* next = nullptr;
+    char* limit = nullptr;
+    /// The strip's head at *next*.
+    std::size_t head = 0;
+    /// Acquisitions that the strip has been counted for, but are yet to be
+    /// made.
+    std::size_t acquisitions = 0;
+  };
+
+  /// Reserve *bytes* of a strip, counted as *acquisitions* acquisitions, into
+  /// the *reservation*, which must be empty. Returns false if no strip has
+  /// room. The strip is counted for one more acquisition, which only
+  /// unreserve() releases, so that it can't reset while the reservation has
+  /// space left to give back, however many of its acquisitions are released.
+  /// Pools recording stats count the acquisitions as acquired up front,
+  /// along with the one more.
+  [[nodiscard]] bool reserve(Reservation& reservation, std::uint32_t bytes, std::size_t acquisitions) noexcept {
+    const Claim claimed = claim(bytes, acquisitions + 1);
+    if ( !claimed.mem ) {
+      return false;
+    }
+    reservation = {claimed.strip, claimed.mem, claimed.mem + bytes, claimed.head, acquisitions};
+    return true;
+  }
+
+  /// Acquire from the *reservation*, which is no more than moving it on, or
+  /// nullptr if it has no room left. Acquisitions are released as any other.
+  [[nodiscard]] static char* acquire(Reservation& reservation, std::uint32_t requested) noexcept {
+    const std::size_t size = paddedSize(requested);
+    if ( reservation.acquisitions == 0 || size > static_cast<std::size_t>(reservation.limit - reservation.next) ) {
+      return nullptr;
+    }
+    char* mem = stamp(reservation.next, reservation.strip, reservation.head, reservation.head + size);
+    reservation.next += size;
+    reservation.head += size;
+    --reservation.acquisitions;
+    return mem;
+  }
+
+  /// Give back what is left of the *reservation* to its strip, in a single
+  /// exchange, leaving it empty. The acquisitions it was counted for but were
+  /// not made are released, and the space left is given back too, if nothing
+  /// has been acquired from the strip since.
+  void unreserve(Reservation& reservation) noexcept {
+    if ( reservation.strip ) {
+      const std::size_t end = reservation.head + static_cast<std::size_t>(reservation.limit - reservation.next);
+      const bool rollBack = end != reservation.head && end <= UINT32_MAX;
+      releaseStrip(
+        reservation.strip,
+        first_head,
+        reservation.acquisitions + 1,
+        rollBack ? reservation.head : 0,
+        rollBack ? end : 0);
+    }
+    reservation = {};
+  }
+
+private:
+  // Every acquisition is prefixed with a pointer back to the strip, and is padded
+  // out to max alignment. The padding keeps the strip's head at the start of
+  // the acquisition, including any alignment padding in front of it, and at
+  // the end, for moving the head back over the acquisition while it is the
+  // strip's last. These are 0 if the head is too large to keep.
+  struct alignas(std::max_align_t) StripPtr {
+    StripHdr* strip;
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  // Each strip uses a bookkeeping bitfield to keep track of both the allocation
+  // *count* and where the *head* of the strip is for the next acqusition.
+  static constexpr word_type count_mask_ = Bookkeeping::count_mask;
+  static constexpr word_type count_inc_ = Bookkeeping::count_inc;
+  static constexpr word_type head_mask_ = Bookkeeping::head_mask;
+
+  static_assert(sizeof(StripHdr) == 2 * alignof(StripHdr*));
+  static_assert(sizeof(StripPtr) == alignof(std::max_align_t));
+
+  /// The space taken up by a *requested* size of acquisition.
+  static constexpr std::size_t paddedSize(std::size_t requested) noexcept {
+    return (requested + sizeof(StripPtr) + alignof(StripPtr) - 1) & ~(alignof(StripPtr) - 1);
+  }
+
+  static StripHdr* stripOf(char* mem) noexcept {
+    return reinterpret_cast<StripPtr*>(mem - sizeof(StripPtr))->strip;
+  }
+
+  /// Fill in the StripPtr at the start of claimed memory *mem*, for an
+  /// acquisition from the *strip* that spans from the *begin* head to the
+  /// *end* head, and return the acquired memory that follows it.
+  static char* stamp(char* mem, StripHdr* strip, std::size_t begin, std::size_t end) noexcept {
+    StripPtr* ptr = reinterpret_cast<StripPtr*>(mem);
+    ptr->strip = strip;
+    const bool kept = end <= UINT32_MAX;
+    ptr->begin = kept ? static_cast<std::uint32_t>(begin) : 0;
+    ptr->end = kept ? static_cast<std::uint32_t>(end) : 0;
+    return mem + sizeof(StripPtr);
+  }
+
+  char* acquireParked(std::uint32_t requested, const std::chrono::steady_clock::time_point* deadline) noexcept {
+    parking_.enter();
+    char* acq = nullptr;
+    while ( true ) {
+      const auto resets = parking_.resets();
+      acq = acquire(requested);
+      if ( acq || (deadline && std::chrono::steady_clock::now() >= *deadline) ) {
+        break;
+      }
+      parking_.park(resets, deadline);
+    }
+    parking_.leave();
+    return acq;
+  }
+
+  StripHdr* stripAt(const std::size_t i) {
+    return reinterpret_cast<StripHdr*>(hdrMem_ + (i * hdrStride_));
+  }
+
+  /// Memory at *head* within the *i*th strip.
+  char* stripMemAt(const std::size_t i, const std::size_t head) {
+    return stripMem_ + (i * stripStride_) + (head - headBias_);
+  }
+
+  /// Move the search for a strip, at the *stripIdx*th strip which is the
+  /// *i*th of the pool, on to the first strip from the *from*th that may have
+  /// room. Returns false, leaving the search where it is, if none may.
+  bool skipTo(std::size_t& stripIdx, std::size_t& i, std::size_t from) noexcept {
+    const std::size_t next = occupancy_.next(from);
+    if ( next == Occupancy::npos ) {
+      return false;
+    }
+    stripIdx += (next + stripCount_ - i) % stripCount_;
+    i = next;
+    return true;
+  }
+
+  // The size of a strip is as if its header was interleaved, so heads are
+  // always relative to where the interleaved header would be, and reset to
+  // the same value whatever the layout.
+  const std::size_t stripSize_;
+  const std::size_t stripCount_;
+  char* stripMem_;
+  const std::size_t stripStride_;
+  char* hdrMem_;
+  const std::size_t hdrStride_;
+  // Amount to subtract from a head to get the offset into the strip's memory,
+  // which is the header size when headers are isolated.
+  const std::size_t headBias_;
+  const StripAffinity affinity_;
+  std::atomic<std::size_t> currentStrip_;
+  [[no_unique_address]] Stats stats_;
+  [[no_unique_address]] Occupancy occupancy_;
+  StripParking parking_;
+
+protected:
+  /// Memory claimed from a strip.
+  struct Claim {
+    /// Start of the claimed memory, or nullptr if nothing could be claimed.
+    char* mem;
+    StripHdr* strip;
+    /// The strip's head at the start of the claimed memory.
+    std::size_t head;
+    /// The strip's head before claiming, which is before any padding for
+    /// alignment.
+    std::size_t begin;
+  };
+
+  /// Claim exactly *requested* bytes from the first strip found with space
+  /// for them, counting them as *acquisitions* of the strip. The caller is
+  /// responsible for keeping the head aligned.
+  /// If an *alignment* is given, the claim is padded at the front so that the
+  /// memory following the StripPtr at the start of the claimed memory is
+  /// aligned to it, and the claimed memory starts after the padding.
+  [[nodiscard]] Claim claim(
+    std::uint32_t requested,
+    std::size_t acquisitions = 1,
+    std::size_t alignment = 0) noexcept
+  {
+    const word_type countAdd = static_cast<word_type>(acquisitions * count_inc_);
+
+    // We start at the last accessed strip, or the thread's own strip, and keep
+    // track of the number of strips interrogated, giving up if we interrogate
+    // all strips.
+    std::size_t stripIdx = affinity_ == StripAffinity::thread
+      ? stripool_thread_slot()
+      : currentStrip_.load(std::memory_order_relaxed);
+    size_t interrogated = 0;
+    std::size_t cas = 0;
+    // With an occupancy bitmap, strips thought to be full are skipped, until
+    // none are thought to have room, when every strip is looked at in turn.
+    bool skipping = Occupancy::enabled;
+    std::size_t scanned = 0;
 
     // 1. Call helper to get strip* for stripIdx
     // 2. Load count and head
     // 3. If the _required_ will fit, attempt to exchange with updated count and head
-    //   3a. If exchanged, return aligned pointer
+    //   3a. If exchanged, return the claimed memory
     //   3b. If fail, check and try again
     // 4. If won't fit, advance to next strip
     //   4a. If all strips interrogated, return nullptr
-    StripHdr* strip = stripAt(stripIdx % stripCount_);
+    std::size_t i = stripIdx % stripCount_;
+    if constexpr ( Occupancy::enabled ) {
+      skipping = skipTo(stripIdx, i, i);
+    }
+    StripHdr* strip = stripAt(i);
     while ( true ) {
       // 1., 2.
-      uint32_t countAndHead = strip->countAndHead.load(std::memory_order_relaxed);
+      word_type countAndHead = strip->countAndHead.load(std::memory_order_relaxed);
 
       // Asking for too big an allocation is a logic error for the intended
       // use cases of this allocator, so we avoid a check up front. An impossible
       // to fill allocation will ultimately fail due to interrogated == stripCount_
-      const auto head = countAndHead & head_mask_;
+      const std::size_t head = countAndHead & head_mask_;
+      const std::size_t padding = alignment
+        ? (0 - reinterpret_cast<std::uintptr_t>(stripMemAt(i, head) + sizeof(StripPtr))) & (alignment - 1)
+        : 0;
 
-      if ( head + requested > stripSize_ ) {
+      // A strip without room to count the acquisitions is just as full as one
+      // without the space.
+      if ( head + padding + requested > stripSize_ || (countAndHead & count_mask_) > count_mask_ - countAdd ) {
         // 4.
         ++interrogated;
-        if (interrogated >= stripCount_) {
+        if constexpr ( Occupancy::enabled ) {
+          if ( skipping ) {
+            // Should the strip have given back space since it was loaded,
+            // it has room again, as far as anyone else is concerned.
+            occupancy_.full(i);
+            if ( strip->countAndHead.load(std::memory_order_relaxed) != countAndHead ) {
+              occupancy_.has_room(i);
+            }
+            // Strips that keep on changing could be skipped to for ever.
+            skipping = interrogated < stripCount_ && skipTo(stripIdx, i, i + 1 == stripCount_ ? 0 : i + 1);
+            strip = stripAt(i);
+            continue;
+          }
+        }
+        ++scanned;
+        if (scanned >= stripCount_) {
           // 4.a
-          return nullptr;
+          if constexpr ( Stats::enabled ) {
+            stats_.acquired(0, interrogated, cas, 0);
+          }
+          return {nullptr, nullptr, 0, 0};
         }
         ++stripIdx;
-        strip = stripAt(stripIdx % stripCount_);
+        i = stripIdx % stripCount_;
+        strip = stripAt(i);
       } else {
         // 3.
-        const auto padding = alignof(StripPtr) - (requested % alignof(StripPtr));
-        if ( head + padding < stripSize_ ) {
-          requested += padding;
-        }
-        const uint32_t update = countAndHead + count_inc_ + requested;
+        const word_type update = countAndHead + countAdd + static_cast<word_type>(padding + requested);
+        ++cas;
+        // Acquiring pairs with the releases of the strip's previous
+        // acquisitions, so their use of the memory happens before ours.
         const bool exchanged = strip->countAndHead.compare_exchange_weak(
           countAndHead,
           update,
-          std::memory_order_release,
+          std::memory_order_acq_rel,
           std::memory_order_relaxed);
         if ( exchanged ) {
           // 3a.
-          char* ret = reinterpret_cast<char*>(strip) + head;
-          reinterpret_cast<StripPtr*>(ret)->strip = strip;
-          ret += sizeof(StripPtr);
           // Since we could allocate from this strip, we're pretty likely to be
           // allocating from it next time, so store it, not caring if another
-          // concurrent allocation also wants to set it.
-          currentStrip_.store(stripIdx, std::memory_order_relaxed);
-          return ret;
-        } else {
-          // 3b. continue
+          // concurrent allocation also wants to set it. Threads with their
+          // own strip always start there, so don't need to store anything.
+          if ( affinity_ == StripAffinity::shared ) {
+            currentStrip_.store(stripIdx, std::memory_order_relaxed);
+          }
+          if constexpr ( Occupancy::enabled ) {
+            if ( !skipping ) {
+              occupancy_.has_room(i);
+            }
+          }
+          if constexpr ( Stats::enabled ) {
+            stats_.acquired(acquisitions, interrogated + 1, cas, update >> Bookkeeping::count_shift);
+          }
+          return {stripMemAt(i, head) + padding, strip, head + padding, head};
         }
+        // 3b. continue
       }
     }
   }
 
-  static void release(char* mem) {
-    // Preceeding the *mem* is a pointer the strip it was acquired from.
-    StripPtr* ptr = reinterpret_cast<StripPtr*>(mem - sizeof(StripPtr));
-    StripHdr* s = ptr->strip;
-    std::uint32_t expectedCountAndHead = s->countAndHead.load(std::memory_order_relaxed);
-    std::uint32_t desiredCountAndHead;
-    do {
-      desiredCountAndHead = expectedCountAndHead - count_inc_;
-      if ( (desiredCountAndHead & count_mask_) == 0 ) {
+  /// Release *acquisitions* from the *strip*, resetting its head to *firstHead*
+  /// if they were the strip's last acquisitions. Otherwise, if the strip's
+  /// head is at the *end* of a single acquisition, the head is moved back to
+  /// its *begin*, unless *end* is 0.
+  static void releaseStrip(
+    StripHdr* strip,
+    std::size_t firstHead = first_head,
+    std::size_t acquisitions = 1,
+    std::size_t begin = 0,
+    std::size_t end = 0) noexcept
+  {
+    const word_type countSub = static_cast<word_type>(acquisitions * count_inc_);
+    word_type expectedCountAndHead = strip->countAndHead.load(std::memory_order_relaxed);
+    std::size_t cas = 0;
+    while ( true ) {
+      ++cas;
+      word_type desiredCountAndHead = expectedCountAndHead - countSub;
+      const bool reset = (desiredCountAndHead & count_mask_) == 0;
+      if ( reset ) {
         // If this exchange is successful, then count would be zero, therefore
         // all acquisitions have been released from the strip, so we get to
         // reset the strip back to pristine state.
-        desiredCountAndHead = sizeof(StripHdr);
+        desiredCountAndHead = static_cast<word_type>(firstHead);
       }
-    } while (!s->countAndHead.compare_exchange_weak(
-        expectedCountAndHead,
-        desiredCountAndHead,
-        std::memory_order_release,
-        std::memory_order_relaxed));
+      // Nothing has been acquired after the acquisition, so its space can go
+      // back to the strip straight away. Should the head have moved away and
+      // back again since, whatever moved it has been released, so the space
+      // is just as free.
+      const bool rolledBack = !reset && end != 0 && (desiredCountAndHead & head_mask_) == end;
+      if ( rolledBack ) {
+        desiredCountAndHead = static_cast<word_type>((desiredCountAndHead & count_mask_) | begin);
+      }
+      if ( strip->countAndHead.compare_exchange_weak(
+          expectedCountAndHead,
+          desiredCountAndHead,
+          std::memory_order_release,
+          std::memory_order_relaxed) ) {
+        if constexpr ( Stats::enabled ) {
+          strip->pool->stats_.released(cas, reset, rolledBack);
+        }
+        if ( reset || rolledBack ) {
+          if constexpr ( Occupancy::enabled ) {
+            strip->pool->occupancy_.gave_back(strip);
+          }
+          if ( strip->pool ) {
+            strip->pool->parking_.strip_reset();
+          }
+        }
+        return;
+      }
+    }
   }
 
-private:
-  /// Each strip consists of a header with the count and head atomic, and is
-  /// padded out to the first acquisition. The header type is made available
-  /// to subclasses, as they must ensure that the strip pointer provided at
-  /// construction accounts for the the header size.
-  struct alignas(std::atomic<std::uint32_t>) StripHdr {
-    std::atomic_uint32_t countAndHead;
-    // Alignof header, since the StripPtr is aligned as such, since that's its first member.
-    [[no_unique_address]] char _pad[alignof(StripHdr*) - sizeof(countAndHead)];
-  };
-
-  // Every acquisition is prefixed with a pointer back to the strip, and is padded
-  // out to max alignment.
-  struct alignas(StripHdr*) StripPtr {
-    StripHdr* strip;
-    [[no_unique_address]] char _pad[alignof(std::max_align_t) - sizeof(strip)];
-  };
-
-  // Each strip uses a u32 bookkeeping bitfield to keep track of both the allocation
-  // *count* and where the *head* of the strip is for the next acqusition.
-
-  // The allocation count is stored in the upper 8 bits, so a mask and shift
-  // are handy to have, as well as a constant for incrementing the count.
-  static constexpr size_t count_mask_ = 0xFF000000;
-  static constexpr size_t count_shift_ = 24; // Amount to shift count and head to get just the count
-  static constexpr size_t count_inc_ = 0x01000000;
-
-  // The head is stored in the lower 24 bits, and we only need a mask for our
-  // operations on it.
-  static constexpr size_t head_mask_ = 0x00FFFFFF;
-
-  static_assert(sizeof(StripHdr) == alignof(StripHdr*));
-  static_assert(sizeof(StripPtr) == alignof(std::max_align_t));
+  /// Detach every strip from the pool, for strips in memory shared with other
+  /// processes, which the pool isn't. Releases then have no waiters to wake,
+  /// so the pool must neither keep stats nor occupancy.
+  void detachStrips() noexcept {
+    static_assert(!Stats::enabled && !Occupancy::enabled);
+    for ( std::size_t i = 0; i < stripCount_; ++i ) {
+      stripAt(i)->pool = nullptr;
+    }
+  }
 
-  StripHdr* stripAt(const std::size_t i) {
-    return reinterpret_cast<StripHdr*>(stripMem_ + (i * stripSize_));
+  /// Seal every strip, so that nothing more can be acquired from the pool, but
+  /// only if the pool holds no acquisitions, as found by every strip's head
+  /// being at *firstHead*. Returns whether the pool was sealed.
+  bool trySeal(std::size_t firstHead = first_head) noexcept {
+    for ( std::size_t i = 0; i < stripCount_; ++i ) {
+      word_type pristine = static_cast<word_type>(firstHead);
+      // A head at the limit of the bookkeeping never has space.
+      if ( !stripAt(i)->countAndHead.compare_exchange_strong(
+          pristine,
+          head_mask_,
+          std::memory_order_acq_rel,
+          std::memory_order_relaxed) ) {
+        unseal(i, firstHead);
+        return false;
+      }
+    }
+    return true;
   }
 
-  const std::size_t stripSize_;
-  const std::size_t stripCount_;
-  char* stripMem_;
-  std::atomic<std::size_t> currentStrip_;
+  /// Unseal the first *stripCount* strips of a pool sealed by trySeal().
+  void unseal(std::size_t stripCount, std::size_t firstHead = first_head) noexcept {
+    for ( std::size_t i = 0; i < stripCount; ++i ) {
+      stripAt(i)->countAndHead.store(static_cast<word_type>(firstHead), std::memory_order_release);
+      if constexpr ( Occupancy::enabled ) {
+        occupancy_.gave_back(stripAt(i));
+      }
+    }
+  }
 
-protected:
   /// Create a stripool that assumes the *stripMem* consists of *stripCount*
   /// strips, each of *rawStripSize* in length. This size must include any space
   /// reserved for a StripHdr and StripPtr.
-  constexpr Stripool(std::size_t rawStripSize, std::size_t stripCount, char* stripMem) noexcept
-    : stripSize_{rawStripSize}, stripCount_{stripCount} , stripMem_{stripMem}, currentStrip_{0}
+  constexpr BasicStripool(
+    std::size_t rawStripSize,
+    std::size_t stripCount,
+    char* stripMem,
+    StripAffinity affinity = StripAffinity::shared) noexcept(!Occupancy::enabled)
+    : BasicStripool{rawStripSize, stripCount, stripMem, nullptr, affinity}
+  {}
+
+  /// Create a stripool that assumes the *stripMem* consists of *stripCount*
+  /// strips, each of *rawStripSize* in length. If *hdrMem* is provided, it must
+  /// be cache line aligned and hold *stripCount* headers of isolated_striphdr_size,
+  /// and the strip size need only include space reserved for a StripPtr.
+  /// Otherwise, headers are interleaved, and the strip size must include any
+  /// space reserved for a StripHdr and StripPtr.
+  /// Strip heads start at *firstHead*, which subclasses releasing with their
+  /// own *firstHead* can use to reserve space after an interleaved header.
+  /// If *attach*, the strips are taken as they are, having been set up by
+  /// another pool over the same memory, such as in another process.
+  constexpr BasicStripool(
+    std::size_t rawStripSize,
+    std::size_t stripCount,
+    char* stripMem,
+    char* hdrMem,
+    StripAffinity affinity = StripAffinity::shared,
+    std::size_t firstHead = first_head,
+    bool attach = false) noexcept(!Occupancy::enabled)
+    : stripSize_{hdrMem ? rawStripSize + first_head : rawStripSize}
+    , stripCount_{stripCount}
+    , stripMem_{stripMem}
+    , stripStride_{rawStripSize}
+    , hdrMem_{hdrMem ? hdrMem : stripMem}
+    , hdrStride_{hdrMem ? isolated_striphdr_size : rawStripSize}
+    , headBias_{hdrMem ? first_head : 0}
+    , affinity_{affinity}
+    , currentStrip_{0}
+    , occupancy_{stripCount, hdrMem_, hdrStride_}
   {
-    // Strip heads are self-relative, so are initialised and reset to the size
-    // of a `strip`, which is the per-strip management data.
-    for ( std::size_t i = 0; i < stripCount; ++i ) {
-      stripAt(i)->countAndHead = sizeof(StripHdr);
-   }
+    // Strip heads are self-relative, so are initialised and reset to just
+    // past the per-strip management data.
+    for ( std::size_t i = 0; i < stripCount && !attach; ++i ) {
+      stripAt(i)->countAndHead = static_cast<word_type>(firstHead);
+      stripAt(i)->pool = this;
+    }
   }
 
   static constexpr std::size_t striphdr_size = sizeof(StripHdr);
   static constexpr std::size_t stripptr_size = sizeof(StripPtr);
+  /// Where strip heads start, and are reset to, which is past an interleaved
+  /// header, padded out so that acquisitions are max aligned. Heads of isolated
+  /// strips are biased by the same amount, so start at the same value.
+  static constexpr std::size_t first_head =
+    (sizeof(StripHdr) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  /// Assumed size of a cache line, which is the space each header takes up
+  /// when headers are isolated.
+  static constexpr std::size_t isolated_striphdr_size = 64;
+
+  /// The size each strip must be for at least 1 acquisition of *stripSize*
+  /// bytes to always succeed, accounting for mandatory padding and bookkeeping.
+  static constexpr std::size_t raw_strip_size_for(std::size_t stripSize, StripLayout layout) {
+    std::size_t size = paddedSize(stripSize);
+    if ( layout == StripLayout::interleaved ) {
+      size += first_head;
+    }
+    return size;
+  }
 };
 
+/// Stripool with the default bookkeeping.
+using Stripool = BasicStripool<>;
+
 
 
 /// Stripool that is backed by a statically sized array that can hold
@@ -202,22 +1319,51 @@ protected:
 /// byte allocation. The actual strip size will be sized larger to account
 /// for mandatory padding and bookkeeping so that at least 1 acquisition of
 /// *strip_size_* will always succed per strip.
-template <std::size_t strip_size_, std::size_t strip_count_>
-struct ArrayStripool : public Stripool
+///
+/// With StripLayout::isolated, the strip headers are held in a separate array
+/// of cache line sized headers, rather than being part of each strip.
+template <
+  std::size_t strip_size_,
+  std::size_t strip_count_,
+  StripLayout layout_ = StripLayout::interleaved,
+  typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>,
+  typename Stats = NoStripStats,
+  typename Occupancy = NoStripOccupancy>
+struct ArrayStripool : public BasicStripool<Bookkeeping, Stats, Occupancy>
 {
-  ArrayStripool() : Stripool{raw_strip_size(), strip_count_, memory_} {}
+  using base = BasicStripool<Bookkeeping, Stats, Occupancy>;
+
+  explicit ArrayStripool(StripAffinity affinity = StripAffinity::shared)
+    : base{
+        raw_strip_size(),
+        strip_count_,
+        memory_ + headers_size,
+        layout_ == StripLayout::isolated ? memory_ : nullptr,
+        affinity}
+  {
+    static_assert(
+      raw_strip_size() + (layout_ == StripLayout::isolated ? first_head : 0)
+        <= Bookkeeping::max_strip_size,
+      "Strips are too large for the bookkeeping to keep track of");
+  }
 
   // For testing purposes
-  const void* memory() const { return memory_; }
+  const void* memory() const { return memory_ + headers_size; }
 
   static consteval std::size_t raw_strip_size() {
-    std::size_t size = strip_size_ + striphdr_size + stripptr_size;
-    size += size % alignof(std::max_align_t);
-    return size;
+    return base::raw_strip_size_for(strip_size_, layout_);
   }
 
 private:
-  alignas(std::max_align_t) char memory_[raw_strip_size() * strip_count_];
+  using base::first_head;
+  using base::isolated_striphdr_size;
+
+  // Isolated headers are kept at the start of the memory, ahead of the strips.
+  static constexpr std::size_t headers_size =
+    layout_ == StripLayout::isolated ? isolated_striphdr_size * strip_count_ : 0;
+
+  alignas(layout_ == StripLayout::isolated ? isolated_striphdr_size : alignof(std::max_align_t))
+  char memory_[headers_size + raw_strip_size() * strip_count_];
 };
 
 }
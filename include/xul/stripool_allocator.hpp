@@ -0,0 +1,178 @@
+#ifndef _xul_stripool_allocator_hpp_
+#define _xul_stripool_allocator_hpp_
+
+#include "stripool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace xul {
+
+/// Standard allocator that acquires from a stripool, for use with standard
+/// containers without the virtual dispatch of StripoolMemoryResource, nor
+/// changing the container types to their std::pmr counterparts.
+///
+/// Should the *Pool* have no room, or the allocation be too large to acquire,
+/// it is allocated from the *Upstream* allocator instead. Deallocating tells
+/// the two apart by whether the memory lies in the pool's strips, and then
+/// releases just as any other acquisition, so the common case touches nothing
+/// but the pool. An empty upstream, such as std::allocator, takes no space, so
+/// the allocator is just a pointer to the pool.
+///
+/// Allocators compare equal when they use the same pool and their upstreams
+/// compare equal, and propagate with their containers on move and swap, so
+/// moving containers around is as cheap as with std::allocator. Allocators
+/// for a pool of static storage duration needn't point to it at all, as with
+/// StaticStripoolAllocator.
+template <typename T, typename Pool = Stripool, typename Upstream = std::allocator<T>>
+class StripoolAllocator
+{
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = StripoolAllocator<U, Pool, typename std::allocator_traits<Upstream>::template rebind_alloc<U>>;
+  };
+
+  explicit StripoolAllocator(Pool& pool, Upstream upstream = {}) noexcept
+    : pool_{&pool}
+    , upstream_{std::move(upstream)}
+  {}
+
+  template <typename U, typename OtherUpstream>
+  StripoolAllocator(const StripoolAllocator<U, Pool, OtherUpstream>& other) noexcept
+    : pool_{other.pool_}
+    , upstream_{other.upstream_}
+  {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+    if ( n <= UINT32_MAX / sizeof(T) ) {
+      char* mem;
+      if constexpr ( alignof(T) > alignof(std::max_align_t) ) {
+        mem = pool_->acquire(static_cast<std::uint32_t>(bytes), alignof(T));
+      } else {
+        mem = pool_->acquire(static_cast<std::uint32_t>(bytes));
+      }
+      if ( mem ) {
+        return reinterpret_cast<T*>(mem);
+      }
+    }
+    return std::allocator_traits<Upstream>::allocate(upstream_, n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if ( pool_->owns(p) ) {
+      Pool::release(reinterpret_cast<char*>(p));
+    } else {
+      std::allocator_traits<Upstream>::deallocate(upstream_, p, n);
+    }
+  }
+
+  Pool& pool() const noexcept { return *pool_; }
+  const Upstream& upstream() const noexcept { return upstream_; }
+
+  template <typename U, typename OtherUpstream>
+  friend bool operator==(const StripoolAllocator& lhs, const StripoolAllocator<U, Pool, OtherUpstream>& rhs) noexcept {
+    return lhs.pool_ == &rhs.pool() && lhs.upstream_ == rhs.upstream();
+  }
+
+private:
+  template <typename, typename, typename>
+  friend class StripoolAllocator;
+
+  Pool* pool_;
+  [[no_unique_address]] Upstream upstream_;
+};
+
+/// StripoolAllocator bound to a *pool_* of static storage duration, rather
+/// than pointing to one, so that it is as stateless as its upstream, which by
+/// default is std::allocator. Containers then hold no allocator, allocators
+/// are always equal, and needn't be given to containers to be constructed:
+///
+///     xul::ArrayStripool<4096, 512> pool;
+///     std::vector<int, xul::StaticStripoolAllocator<int, pool>> ints;
+///
+/// Deallocating still tells acquisitions apart from upstream allocations by
+/// whether the memory lies in the pool's strips, but against a pool at an
+/// address known at compile time.
+template <typename T, auto& pool_, typename Upstream = std::allocator<T>>
+class StaticStripoolAllocator
+{
+public:
+  using Pool = std::remove_reference_t<decltype(pool_)>;
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using is_always_equal = typename std::allocator_traits<Upstream>::is_always_equal;
+  using propagate_on_container_copy_assignment =
+    typename std::allocator_traits<Upstream>::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment =
+    typename std::allocator_traits<Upstream>::propagate_on_container_move_assignment;
+  using propagate_on_container_swap = typename std::allocator_traits<Upstream>::propagate_on_container_swap;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = StaticStripoolAllocator<U, pool_, typename std::allocator_traits<Upstream>::template rebind_alloc<U>>;
+  };
+
+  StaticStripoolAllocator() = default;
+
+  explicit StaticStripoolAllocator(Upstream upstream) noexcept
+    : upstream_{std::move(upstream)}
+  {}
+
+  template <typename U, typename OtherUpstream>
+  StaticStripoolAllocator(const StaticStripoolAllocator<U, pool_, OtherUpstream>& other) noexcept
+    : upstream_{other.upstream()}
+  {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+    if ( n <= UINT32_MAX / sizeof(T) ) {
+      char* mem;
+      if constexpr ( alignof(T) > alignof(std::max_align_t) ) {
+        mem = pool_.acquire(static_cast<std::uint32_t>(bytes), alignof(T));
+      } else {
+        mem = pool_.acquire(static_cast<std::uint32_t>(bytes));
+      }
+      if ( mem ) {
+        return reinterpret_cast<T*>(mem);
+      }
+    }
+    return std::allocator_traits<Upstream>::allocate(upstream_, n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if ( pool_.owns(p) ) {
+      Pool::release(reinterpret_cast<char*>(p));
+    } else {
+      std::allocator_traits<Upstream>::deallocate(upstream_, p, n);
+    }
+  }
+
+  static Pool& pool() noexcept { return pool_; }
+  const Upstream& upstream() const noexcept { return upstream_; }
+
+  template <typename U, typename OtherUpstream>
+  friend bool operator==(const StaticStripoolAllocator& lhs, const StaticStripoolAllocator<U, pool_, OtherUpstream>& rhs) noexcept {
+    return lhs.upstream_ == rhs.upstream();
+  }
+
+private:
+  [[no_unique_address]] Upstream upstream_;
+};
+
+}
+
+#endif
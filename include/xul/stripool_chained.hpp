@@ -0,0 +1,212 @@
+#ifndef _xul_stripool_chained_hpp_
+#define _xul_stripool_chained_hpp_
+
+#include "stripool_dynamic.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace xul {
+
+/// Configuration of a ChainedStripool.
+struct ChainedStripoolConfig
+{
+  /// Configuration of the pool's primary segment, and every segment chained
+  /// on to it.
+  DynamicStripoolConfig segment;
+  /// The most segments that can be chained on to the primary segment.
+  std::size_t maxSegments;
+};
+
+/// Stripool that grows under pressure, by chaining on further segments of
+/// strips when its primary segment is exhausted, up to a ceiling. Each segment
+/// is a DynamicStripool, so acquisitions are released just as any other
+/// acquisition from a Stripool with the same bookkeeping, without knowing the
+/// segment they came from.
+///
+/// Segments are chained on without locks: the thread that finds the pool
+/// exhausted maps a new segment and links it into the first free slot, with
+/// any thread losing a race to do so unmapping its segment and using the
+/// winner's instead.
+///
+/// Segments that go unused are given back by calling trim() periodically, as
+/// appropriate for the application. A segment is only given back once it
+/// has gone unused for the given number of calls to trim(), and holds no
+/// acquisitions.
+///
+/// Acquiring from chained segments is a little costlier than from the primary
+/// segment, as each segment looked at is guarded against being trimmed
+/// while it is being looked at.
+template <typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>>
+struct BasicChainedStripool
+{
+  /// Create a pool with the primary segment as described by the *config*.
+  /// Throws as per DynamicStripool.
+  explicit BasicChainedStripool(const ChainedStripoolConfig& config)
+    : config_{config}
+    , primary_{config.segment}
+    , slots_{std::make_unique<Slot[]>(config.maxSegments)}
+  {}
+
+  ~BasicChainedStripool() {
+    for ( std::size_t i = 0; i < config_.maxSegments; ++i ) {
+      delete slots_[i].segment.load(std::memory_order_relaxed);
+    }
+  }
+
+  BasicChainedStripool(const BasicChainedStripool&) = delete;
+  BasicChainedStripool& operator=(const BasicChainedStripool&) = delete;
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    if ( char* acq = primary_.acquire(requested) ) {
+      return acq;
+    }
+    // Chained segments are acquired from in order, so that later segments are
+    // left idle, and can be trimmed, once the pressure is off.
+    std::size_t i = 0;
+    while ( i < config_.maxSegments ) {
+      Slot& slot = slots_[i];
+      SlotGuard guard{slot};
+      Segment* segment = slot.segment.load();
+      if ( !segment ) {
+        // Acquire from the new segment before linking it in, so that other
+        // threads can't exhaust it first.
+        segment = newSegment();
+        if ( !segment ) {
+          return nullptr;
+        }
+        char* acq = segment->acquire(requested);
+        if ( !acq ) {
+          // Too large for any strip, so chaining on more segments won't help.
+          delete segment;
+          return nullptr;
+        }
+        slot.lastUsed.store(trims_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        Segment* empty = nullptr;
+        if ( slot.segment.compare_exchange_strong(empty, segment) ) {
+          return acq;
+        }
+        // Another thread chained on a segment first, so use theirs instead.
+        delete segment;
+        segment = empty;
+      }
+      if ( char* acq = segment->acquire(requested) ) {
+        slot.markUsed(trims_.load(std::memory_order_relaxed));
+        return acq;
+      }
+      ++i;
+    }
+    // Every segment is exhausted, and there is no room for another.
+    return nullptr;
+  }
+
+  static void release(char* mem) noexcept {
+    BasicStripool<Bookkeeping>::release(mem);
+  }
+
+  /// Give back every chained segment that holds no acquisitions, and has not
+  /// been acquired from since the last *idleTrims* calls to trim(). Returns
+  /// the number of segments given back.
+  /// Trimming is intended to be done periodically by a single thread, but
+  /// is safe to do concurrently with acquiring and releasing. It may briefly
+  /// wait for threads that are looking at a segment that is being trimmed.
+  /// Trimming while another thread is trimming does nothing.
+  std::size_t trim(unsigned idleTrims = 1) {
+    if ( trimming_.test_and_set(std::memory_order_acquire) ) {
+      return 0;
+    }
+    const auto trims = trims_.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t trimmed = 0;
+    for ( std::size_t i = 0; i < config_.maxSegments; ++i ) {
+      Slot& slot = slots_[i];
+      Segment* segment = slot.segment.load();
+      if ( !segment || trims - slot.lastUsed.load(std::memory_order_relaxed) <= idleTrims ) {
+        continue;
+      }
+      // Once sealed, nothing can be acquired from the segment, and since it
+      // held nothing, there is nothing to be released to it.
+      if ( !segment->trySeal() ) {
+        continue;
+      }
+      slot.segment.store(nullptr);
+      // Threads may have loaded the segment before it was unlinked, so wait
+      // until they are done with it before unmapping it.
+      while ( slot.users.load() != 0 ) {
+        std::this_thread::yield();
+      }
+      delete segment;
+      ++trimmed;
+    }
+    trimming_.clear(std::memory_order_release);
+    return trimmed;
+  }
+
+  /// Number of segments currently chained on to the primary segment.
+  std::size_t segments() const noexcept {
+    std::size_t count = 0;
+    for ( std::size_t i = 0; i < config_.maxSegments; ++i ) {
+      count += slots_[i].segment.load(std::memory_order_relaxed) != nullptr;
+    }
+    return count;
+  }
+
+private:
+  struct Segment : public BasicDynamicStripool<Bookkeeping>
+  {
+    using BasicDynamicStripool<Bookkeeping>::BasicDynamicStripool;
+    using BasicDynamicStripool<Bookkeeping>::trySeal;
+    static constexpr auto cache_line_size = BasicDynamicStripool<Bookkeeping>::isolated_striphdr_size;
+  };
+
+  /// Each chained segment is held in its own slot, with the slot counting the
+  /// threads that are using it, to guard the segment from being unmapped while
+  /// in use. Slots are cache line aligned so that threads using one slot don't
+  /// contend with those using another.
+  struct alignas(Segment::cache_line_size) Slot
+  {
+    std::atomic<Segment*> segment{nullptr};
+    std::atomic<std::size_t> users{0};
+    // The value of trims_ when the segment was last acquired from.
+    std::atomic<std::uint64_t> lastUsed{0};
+
+    void markUsed(std::uint64_t trims) noexcept {
+      // Only store when it changes, so that repeat acquisitions aren't all
+      // writing to the slot.
+      if ( lastUsed.load(std::memory_order_relaxed) != trims ) {
+        lastUsed.store(trims, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  struct SlotGuard
+  {
+    explicit SlotGuard(Slot& slot) noexcept : slot_{slot} { slot_.users.fetch_add(1); }
+    ~SlotGuard() { slot_.users.fetch_sub(1); }
+    Slot& slot_;
+  };
+
+  /// Map a new segment, or nullptr if it could not be mapped.
+  Segment* newSegment() noexcept {
+    try {
+      return new Segment{config_.segment};
+    } catch ( ... ) {
+      return nullptr;
+    }
+  }
+
+  const ChainedStripoolConfig config_;
+  BasicDynamicStripool<Bookkeeping> primary_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<std::uint64_t> trims_{0};
+  std::atomic_flag trimming_;
+};
+
+/// ChainedStripool with the default bookkeeping.
+using ChainedStripool = BasicChainedStripool<>;
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef _xul_stripool_dynamic_hpp_
+#define _xul_stripool_dynamic_hpp_
+
+#include "stripool.hpp"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace xul {
+
+/// The pages backing a DynamicStripool's memory.
+enum class StripPages
+{
+  /// Regular pages.
+  standard,
+  /// Regular pages, aligned to and advised for transparent huge pages, which
+  /// the kernel may back them with if it has them enabled.
+  transparent_huge,
+  /// Huge pages from the system's reserved pool, via MAP_HUGETLB. If none are
+  /// available, falls back to transparent_huge.
+  huge,
+};
+
+/// Private anonymous memory mapping, optionally backed by huge pages,
+/// optionally bound to a NUMA node, and optionally prefaulted so that first
+/// touching the memory is not a page fault.
+class StripMapping
+{
+public:
+  /// The huge page size assumed when aligning and sizing huge page mappings.
+  static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+  /// Map at least *size* bytes. If *node* is not negative, the memory is bound
+  /// to that NUMA node before any of it is touched, unless the system can't,
+  /// in which case it is left to be placed as it is first touched. Throws
+  /// std::system_error if the memory could not be mapped.
+  StripMapping(std::size_t size, StripPages pages, bool prefault, int node = -1)
+    : pages_{pages}
+  {
+    if ( node < 0 ) {
+      mapPages(size, prefault);
+      return;
+    }
+    // Populating the mapping would fault in the pages before they're bound,
+    // so they are faulted in by touching them once bound instead.
+    mapPages(size, false);
+    std::vector<unsigned long> nodeMask(node / (8 * sizeof(unsigned long)) + 1);
+    nodeMask.back() = 1ul << (node % (8 * sizeof(unsigned long)));
+    // Binding fails without NUMA support, or for nodes the system doesn't
+    // have, which is no worse than not binding.
+    ::syscall(SYS_mbind, data_, size_, MPOL_BIND, nodeMask.data(), nodeMask.size() * 8 * sizeof(unsigned long) + 1, 0);
+    if ( prefault ) {
+      touch();
+    }
+  }
+
+  ~StripMapping() { ::munmap(data_, size_); }
+
+  StripMapping(const StripMapping&) = delete;
+  StripMapping& operator=(const StripMapping&) = delete;
+
+  char* data() const noexcept { return data_; }
+  /// Size of the mapping, which is at least as large as requested.
+  std::size_t size() const noexcept { return size_; }
+  /// The pages actually backing the mapping, which is only different to
+  /// those asked for if huge pages were unavailable.
+  StripPages pages() const noexcept { return pages_; }
+
+private:
+  void mapPages(std::size_t size, bool prefault) {
+    if ( pages_ == StripPages::huge ) {
+      size_ = roundUp(size, huge_page_size);
+      void* mapped = ::mmap(
+        nullptr,
+        size_,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0),
+        -1,
+        0);
+      if ( mapped != MAP_FAILED ) {
+        data_ = static_cast<char*>(mapped);
+        return;
+      }
+      pages_ = StripPages::transparent_huge;
+    }
+
+    if ( pages_ == StripPages::transparent_huge ) {
+      // Over-map so the memory can be aligned to a huge page, which the kernel
+      // needs to back it with one, then unmap the excess either side.
+      size_ = roundUp(size, huge_page_size);
+      char* mapped = map(size_ + huge_page_size, 0);
+      char* aligned = reinterpret_cast<char*>(
+        roundUp(reinterpret_cast<std::uintptr_t>(mapped), huge_page_size));
+      if ( aligned != mapped ) {
+        ::munmap(mapped, aligned - mapped);
+      }
+      ::munmap(aligned + size_, (mapped + huge_page_size) - aligned);
+      data_ = aligned;
+      // Transparent huge pages may be disabled, in which case this fails,
+      // and we just have regular pages.
+      ::madvise(data_, size_, MADV_HUGEPAGE);
+      if ( prefault ) {
+        // Populating the mapping would fault in regular pages before the advice
+        // applies, so the pages are faulted in by touching them instead.
+        touch();
+      }
+      return;
+    }
+
+    size_ = size;
+    data_ = map(size_, prefault ? MAP_POPULATE : 0);
+  }
+
+  /// Fault in every page by touching it.
+  void touch() {
+    const std::size_t pageSize = ::sysconf(_SC_PAGESIZE);
+    for ( std::size_t offset = 0; offset < size_; offset += pageSize ) {
+      *static_cast<volatile char*>(data_ + offset) = 0;
+    }
+  }
+
+  static constexpr std::size_t roundUp(std::size_t n, std::size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+  }
+
+  static char* map(std::size_t size, int flags) {
+    void* mapped = ::mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | flags,
+      -1,
+      0);
+    if ( mapped == MAP_FAILED ) {
+      throw std::system_error{errno, std::generic_category(), "Failed to map stripool memory"};
+    }
+    return static_cast<char*>(mapped);
+  }
+
+  char* data_;
+  std::size_t size_;
+  StripPages pages_;
+};
+
+/// Configuration of a DynamicStripool, typically determined at startup.
+struct DynamicStripoolConfig
+{
+  /// The size of acquisition that every strip must be able to hold, as with
+  /// ArrayStripool's *strip_size_*.
+  std::size_t stripSize;
+  std::size_t stripCount;
+  StripLayout layout{StripLayout::interleaved};
+  StripAffinity affinity{StripAffinity::shared};
+  StripPages pages{StripPages::standard};
+  /// Fault in all the memory up front, so acquisitions never incur the cost
+  /// of first touching a page.
+  bool prefault{false};
+  /// NUMA node to bind the memory to, or -1 to leave it to be placed on
+  /// whichever node first touches it.
+  int node{-1};
+};
+
+/// Stripool that is sized at runtime, and maps its memory from the system,
+/// rather than embedding it. This suits large pools, which can also be backed
+/// by huge pages to reduce TLB misses.
+///
+/// Isolated headers are kept at the start of the mapping, ahead of the strips.
+template <
+  typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>,
+  typename Stats = NoStripStats,
+  typename Occupancy = NoStripOccupancy>
+struct BasicDynamicStripool : private StripMapping, public BasicStripool<Bookkeeping, Stats, Occupancy>
+{
+  using base = BasicStripool<Bookkeeping, Stats, Occupancy>;
+
+  /// Create a pool as described by the *config*. Throws std::invalid_argument
+  /// if the configuration cannot be catered for by the bookkeeping, and
+  /// std::system_error if the memory cannot be mapped.
+  explicit BasicDynamicStripool(const DynamicStripoolConfig& config)
+    : StripMapping{validated(config).stripCount * rawStripSize(config) + headersSize(config),
+        config.pages, config.prefault, config.node}
+    , base{
+        rawStripSize(config),
+        config.stripCount,
+        StripMapping::data() + headersSize(config),
+        config.layout == StripLayout::isolated ? StripMapping::data() : nullptr,
+        config.affinity}
+    , headersSize_{headersSize(config)}
+  {}
+
+  /// The pages actually backing the pool.
+  StripPages pages() const noexcept { return StripMapping::pages(); }
+  /// Size of the memory mapped for the pool.
+  std::size_t mapped_size() const noexcept { return StripMapping::size(); }
+
+  // For testing purposes
+  const void* memory() const { return StripMapping::data() + headersSize_; }
+
+private:
+  static std::size_t rawStripSize(const DynamicStripoolConfig& config) {
+    return base::raw_strip_size_for(config.stripSize, config.layout);
+  }
+
+  static std::size_t headersSize(const DynamicStripoolConfig& config) {
+    return config.layout == StripLayout::isolated
+      ? base::isolated_striphdr_size * config.stripCount
+      : 0;
+  }
+
+  static const DynamicStripoolConfig& validated(const DynamicStripoolConfig& config) {
+    if ( config.stripCount == 0 ) {
+      throw std::invalid_argument{"Stripool must have at least one strip"};
+    }
+    const std::size_t isolatedHdr =
+      config.layout == StripLayout::isolated ? base::first_head : 0;
+    if ( rawStripSize(config) + isolatedHdr > Bookkeeping::max_strip_size ) {
+      throw std::invalid_argument{"Strips are too large for the bookkeeping to keep track of"};
+    }
+    return config;
+  }
+
+  const std::size_t headersSize_;
+};
+
+/// DynamicStripool with the default bookkeeping.
+using DynamicStripool = BasicDynamicStripool<>;
+
+}
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef _xul_stripool_epoch_hpp_
+#define _xul_stripool_epoch_hpp_
+
+#include "stripool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace xul {
+
+/// Epoch based reclamation for acquisitions from a *Pool* that are used by
+/// lock free readers, such as the nodes of a read mostly linked structure.
+/// Releasing a node while a reader may still hold a pointer to it would let
+/// its strip reset and the memory be reused under the reader, so nodes are
+/// retired instead, and only released once every reader has passed a point
+/// where it holds no pointers into the structure.
+///
+/// Each thread that reads or retires takes part through a Participant of its
+/// own, typically a thread_local one. Readers access the structure within a
+/// guard, which announces the epoch they read in. The epoch is only advanced
+/// when every reader within a guard has announced the current one, and
+/// acquisitions retired in an epoch are released once it has advanced twice
+/// more, when no reader can still be reading from before they were retired.
+///
+/// Retired acquisitions are kept by their participant, so retiring takes no
+/// atomic operations. Every batch_size retirements, the participant tags them
+/// with the epoch as a batch, tries to advance the epoch, and releases the
+/// batches that have become safe to. Readers that stay within a guard hold
+/// back every release, so guards should be short.
+template <typename Pool = Stripool>
+class StripEpochs
+{
+public:
+  /// Retirements a participant batches up before trying to advance the epoch.
+  static constexpr std::size_t batch_size = 64;
+
+  class Participant;
+
+  StripEpochs() = default;
+  StripEpochs(const StripEpochs&) = delete;
+  StripEpochs& operator=(const StripEpochs&) = delete;
+
+  /// Releases anything left over by participants that have gone, which must
+  /// be all of them.
+  ~StripEpochs() {
+    for ( const auto& [epoch, mem] : orphans_ ) {
+      Pool::release(mem);
+    }
+  }
+
+  std::uint64_t epoch() const noexcept { return epoch_.load(std::memory_order_acquire); }
+
+  /// Advance the epoch, if every reader within a guard has seen the current
+  /// one, returning the epoch as it now stands. Acquisitions left over by
+  /// participants that have gone are released once it is safe to.
+  std::uint64_t try_advance() noexcept {
+    const std::scoped_lock lock{mutex_};
+    std::uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+    // Pairs with the fence of readers entering guards, so that either their
+    // announcement is seen here, or they see everything unlinked before the
+    // epoch was read.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool behind = false;
+    for ( const Participant* participant = participants_; participant && !behind; participant = participant->next_ ) {
+      const std::uint64_t announced = participant->announced_.load(std::memory_order_relaxed);
+      behind = announced != idle && announced != epoch;
+    }
+    if ( !behind ) {
+      epoch_.store(++epoch, std::memory_order_release);
+    }
+    std::erase_if(orphans_, [epoch](const auto& orphan) {
+      if ( orphan.first + 2 > epoch ) {
+        return false;
+      }
+      Pool::release(orphan.second);
+      return true;
+    });
+    return epoch;
+  }
+
+  /// A thread's part in the reclamation, for reading within guards, and
+  /// retiring acquisitions. A participant must only be used by one thread
+  /// at a time, and leaves anything it retired that is not yet safe to
+  /// release with the StripEpochs when it goes.
+  class Participant
+  {
+  public:
+    explicit Participant(StripEpochs& epochs) : epochs_{epochs} {
+      const std::scoped_lock lock{epochs_.mutex_};
+      next_ = epochs_.participants_;
+      epochs_.participants_ = this;
+    }
+
+    Participant(const Participant&) = delete;
+    Participant& operator=(const Participant&) = delete;
+
+    ~Participant() {
+      const std::scoped_lock lock{epochs_.mutex_};
+      Participant** link = &epochs_.participants_;
+      while ( *link != this ) {
+        link = &(*link)->next_;
+      }
+      *link = next_;
+      seal();
+      for ( auto& batch : batches_ ) {
+        for ( char* mem : batch.mems ) {
+          epochs_.orphans_.emplace_back(batch.epoch, mem);
+        }
+      }
+    }
+
+    /// Reading within a guard, for as long as it is in scope.
+    class Guard
+    {
+    public:
+      explicit Guard(Participant& participant) noexcept : participant_{participant} { participant_.enter(); }
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+      ~Guard() { participant_.leave(); }
+
+    private:
+      Participant& participant_;
+    };
+
+    [[nodiscard]] Guard guard() noexcept { return Guard{*this}; }
+
+    /// Start reading, announcing the current epoch. Guards may be nested.
+    void enter() noexcept {
+      if ( depth_++ == 0 ) {
+        announced_.store(epochs_.epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+    }
+
+    /// Stop reading, after which no pointers into the structure may be held.
+    void leave() noexcept {
+      if ( --depth_ == 0 ) {
+        announced_.store(idle, std::memory_order_release);
+      }
+    }
+
+    /// Release the acquisition *mem*, already unlinked from the structure,
+    /// once no reader can still be using it.
+    void retire(char* mem) {
+      retired_.push_back(mem);
+      if ( retired_.size() >= batch_size ) {
+        collect();
+      }
+    }
+
+    /// Release whatever is safe to, trying to advance the epoch first, as
+    /// when the thread has stopped retiring for a while.
+    void collect() {
+      seal();
+      const std::uint64_t epoch = epochs_.try_advance();
+      std::erase_if(batches_, [epoch](Batch& batch) {
+        if ( batch.epoch + 2 > epoch ) {
+          return false;
+        }
+        for ( char* mem : batch.mems ) {
+          Pool::release(mem);
+        }
+        return true;
+      });
+    }
+
+    /// Acquisitions retired and yet to be released.
+    std::size_t pending() const noexcept {
+      std::size_t pending = retired_.size();
+      for ( const auto& batch : batches_ ) {
+        pending += batch.mems.size();
+      }
+      return pending;
+    }
+
+  private:
+    friend class StripEpochs;
+
+    /// Acquisitions retired in an epoch.
+    struct Batch
+    {
+      std::uint64_t epoch;
+      std::vector<char*> mems;
+    };
+
+    /// Put what has been retired since the last batch into a batch of its
+    /// own. Everything in it was unlinked before the fence, so readers that
+    /// announce an earlier epoch than is read after it could still be using
+    /// them, but readers that enter after could not, so it is safe to tag
+    /// them all with that epoch, late as it may be.
+    void seal() {
+      if ( retired_.empty() ) {
+        return;
+      }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      batches_.push_back({epochs_.epoch(), std::exchange(retired_, {})});
+      retired_.reserve(batch_size);
+    }
+
+    StripEpochs& epochs_;
+    Participant* next_ = nullptr;
+    std::size_t depth_ = 0;
+    std::vector<char*> retired_;
+    std::vector<Batch> batches_;
+    alignas(64) std::atomic<std::uint64_t> announced_{idle};
+  };
+
+private:
+  /// Announced by participants that are not reading.
+  static constexpr std::uint64_t idle = UINT64_MAX;
+
+  // Epochs start at 2, so that batches start out as safe to release.
+  alignas(64) std::atomic<std::uint64_t> epoch_{2};
+  std::mutex mutex_;
+  Participant* participants_ = nullptr;
+  std::vector<std::pair<std::uint64_t, char*>> orphans_;
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef _xul_stripool_magazine_hpp_
+#define _xul_stripool_magazine_hpp_
+
+#include "stripool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace xul {
+
+/// Cache in front of a stripool for a single thread, which reserves a chunk of
+/// a strip at a time, and acquires from it by just moving on through it, with
+/// no atomic operations. The chunk is counted in its strip for a number of
+/// acquisitions up front, so each acquisition is released as any other, from
+/// any thread, and what is left of the chunk is given back to the strip in a
+/// single exchange once it runs out, or the magazine is destroyed.
+///
+/// Magazines are meant to be kept by each thread, for small acquisitions that
+/// are made often, such as those of handling a request:
+///
+///     thread_local xul::StripMagazine magazine{pool};
+///     char* mem = magazine.acquire(48);
+///     ...
+///     magazine.release(mem);
+///
+/// The pool must outlive the magazine. Strips hold on to the chunk reserved
+/// from them until the magazine moves on, so it is best that chunks are a
+/// small part of a strip, and that threads do not hold on to magazines they
+/// have finished with.
+template <typename Pool = Stripool>
+class StripMagazine
+{
+public:
+  /// Magazine reserving chunks of *chunkSize* bytes from the *pool*, each
+  /// for up to *acquisitions* acquisitions, which is limited by how many a
+  /// strip can count, less the one that holds the strip for the chunk. Chunks must fit in the pool's strips, after their
+  /// headers, and are rounded up to keep acquisitions aligned. Acquisitions
+  /// too large for a chunk are made from the pool directly.
+  explicit StripMagazine(Pool& pool, std::uint32_t chunkSize = 1024, std::size_t acquisitions = 64) noexcept
+    : pool_{pool}
+    , chunkSize_{std::max<std::uint32_t>((chunkSize + align - 1) & ~(align - 1), 2 * align)}
+    , acquisitions_{std::clamp<std::size_t>(acquisitions, 1, Pool::bookkeeping::max_count - 1)}
+  {}
+
+  StripMagazine(const StripMagazine&) = delete;
+  StripMagazine& operator=(const StripMagazine&) = delete;
+
+  ~StripMagazine() { pool_.unreserve(reservation_); }
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    if ( char* mem = Pool::acquire(reservation_, requested) ) {
+      return mem;
+    }
+    return reload(requested);
+  }
+
+  static void release(char* mem) noexcept {
+    Pool::release(mem);
+  }
+
+  /// Give back what is left of the current chunk, as when a thread is to be
+  /// idle for a while.
+  void drain() noexcept { pool_.unreserve(reservation_); }
+
+  Pool& pool() const noexcept { return pool_; }
+
+private:
+  using Reservation = typename Pool::Reservation;
+
+  static constexpr std::uint32_t align = alignof(std::max_align_t);
+
+  /// Move on to a new chunk to acquire from, with the current one drained,
+  /// unless the acquisition wouldn't fit in one anyway.
+  char* reload(std::uint32_t requested) noexcept {
+    if ( requested > chunkSize_ - align ) {
+      return pool_.acquire(requested);
+    }
+    pool_.unreserve(reservation_);
+    if ( pool_.reserve(reservation_, chunkSize_, acquisitions_) ) {
+      return Pool::acquire(reservation_, requested);
+    }
+    return pool_.acquire(requested);
+  }
+
+  Pool& pool_;
+  const std::uint32_t chunkSize_;
+  const std::size_t acquisitions_;
+  Reservation reservation_;
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef _xul_stripool_masked_hpp_
+#define _xul_stripool_masked_hpp_
+
+#include "stripool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace xul {
+
+/// Stripool whose acquisitions are not preceeded by a pointer back to their
+/// strip. Instead, strips are *strip_size_* bytes, a power of two, and aligned
+/// to their size, so the strip an acquisition belongs to is found by masking
+/// off the lower bits of its address.
+///
+/// Acquisitions are packed together, only padded out to keep each of them
+/// maximally aligned. For small acquisitions, this makes the pool considerably
+/// denser, and keeps the first acquisition on the same cache line as the
+/// strip's header.
+///
+/// Headers are always interleaved, since the masked address is the header's.
+/// Acquisitions must be released by a pool of the same strip size and
+/// bookkeeping, which is why this is not a Stripool.
+template <std::size_t strip_size_, typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>>
+struct BasicMaskedStripool : private BasicStripool<Bookkeeping>
+{
+  static_assert(std::has_single_bit(strip_size_), "Strips must be a power of two in size");
+  static_assert(strip_size_ <= Bookkeeping::max_strip_size,
+    "Strips are too large for the bookkeeping to keep track of");
+
+  using bookkeeping = Bookkeeping;
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    // A zero sized acquisition at the very end of a strip would be masked to
+    // the following strip, so every acquisition takes up some space.
+    requested = std::max<std::uint32_t>(requested, 1);
+    requested = (requested + max_align - 1) & ~(max_align - 1);
+    return this->claim(requested).mem;
+  }
+
+  static void release(char* mem) noexcept {
+    const auto strip = reinterpret_cast<std::uintptr_t>(mem) & ~(strip_size_ - 1);
+    base::releaseStrip(reinterpret_cast<StripHdr*>(strip), first_head);
+  }
+
+protected:
+  /// Create a masked stripool that assumes the *stripMem* consists of
+  /// *stripCount* strips, and is aligned to *strip_size_*.
+  BasicMaskedStripool(
+    std::size_t stripCount,
+    char* stripMem,
+    StripAffinity affinity = StripAffinity::shared) noexcept
+    : base{strip_size_, stripCount, stripMem, nullptr, affinity, first_head}
+  {}
+
+private:
+  using base = BasicStripool<Bookkeeping>;
+  using typename base::StripHdr;
+
+  using base::first_head;
+
+  static constexpr std::size_t max_align = alignof(std::max_align_t);
+};
+
+/// Masked stripool that is backed by a statically sized array of
+/// *strip_count_* strips, each *strip_size_* bytes, and aligned as such.
+/// Large strips are best kept out of automatic storage.
+template <
+  std::size_t strip_size_,
+  std::size_t strip_count_,
+  typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>>
+struct ArrayMaskedStripool : public BasicMaskedStripool<strip_size_, Bookkeeping>
+{
+  using base = BasicMaskedStripool<strip_size_, Bookkeeping>;
+
+  explicit ArrayMaskedStripool(StripAffinity affinity = StripAffinity::shared)
+    : base{strip_count_, memory_, affinity}
+  {}
+
+  // For testing purposes
+  const void* memory() const { return memory_; }
+
+private:
+  alignas(strip_size_) char memory_[strip_size_ * strip_count_];
+};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef _xul_stripool_numa_hpp_
+#define _xul_stripool_numa_hpp_
+
+#include "stripool_dynamic.hpp"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xul {
+
+/// The NUMA nodes of a system, and the node each CPU is on.
+class NumaTopology
+{
+public:
+  /// Topology of *nodeCount* nodes, with the *cpuNodes* giving the node of
+  /// each CPU, by CPU number. Any other CPUs are taken to be on node 0.
+  NumaTopology(std::size_t nodeCount, std::vector<std::size_t> cpuNodes)
+    : nodeCount_{std::max<std::size_t>(nodeCount, 1)}
+    , cpuNodes_{std::move(cpuNodes)}
+  {}
+
+  /// The system's topology, as described by sysfs, or a single node if that
+  /// can't be read, as on systems without NUMA support.
+  static NumaTopology system() {
+    const auto nodes = readList("/sys/devices/system/node/online");
+    if ( nodes.empty() ) {
+      return {1, {}};
+    }
+    std::vector<std::size_t> cpuNodes;
+    for ( const auto node : nodes ) {
+      for ( const auto cpu : readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist") ) {
+        if ( cpu >= cpuNodes.size() ) {
+          cpuNodes.resize(cpu + 1);
+        }
+        cpuNodes[cpu] = node;
+      }
+    }
+    // Node numbers can have gaps, which are given nodes of their own, with
+    // no CPUs, rather than renumbering them.
+    return {*std::ranges::max_element(nodes) + 1, std::move(cpuNodes)};
+  }
+
+  std::size_t node_count() const noexcept { return nodeCount_; }
+
+  std::size_t node_of_cpu(std::size_t cpu) const noexcept {
+    return cpu < cpuNodes_.size() ? cpuNodes_[cpu] : 0;
+  }
+
+  /// Node of the CPU the calling thread is running on, which may change as
+  /// soon as it is returned, unless the thread is pinned to the node.
+  std::size_t current_node() const noexcept {
+    const int cpu = ::sched_getcpu();
+    return cpu < 0 ? 0 : node_of_cpu(cpu);
+  }
+
+private:
+  /// Read a sysfs list, such as "0-3,8-11", of the numbers in the file at
+  /// *path*, which is empty if the file can't be read.
+  static std::vector<std::size_t> readList(const std::string& path) {
+    std::vector<std::size_t> numbers;
+    std::ifstream file{path};
+    std::string range;
+    while ( std::getline(file, range, ',') ) {
+      std::istringstream in{range};
+      std::size_t first = 0;
+      std::size_t last = 0;
+      char dash = 0;
+      if ( !(in >> first) ) {
+        continue;
+      }
+      last = (in >> dash >> last) && dash == '-' ? last : first;
+      for ( std::size_t n = first; n <= last; ++n ) {
+        numbers.push_back(n);
+      }
+    }
+    return numbers;
+  }
+
+  std::size_t nodeCount_;
+  std::vector<std::size_t> cpuNodes_;
+};
+
+/// Configuration of a NumaStripool, typically determined at startup.
+struct NumaStripoolConfig
+{
+  /// The size of acquisition that every strip must be able to hold, as with
+  /// ArrayStripool's *strip_size_*.
+  std::size_t stripSize;
+  /// Number of strips in each node's partition.
+  std::size_t stripsPerNode;
+  StripLayout layout{StripLayout::interleaved};
+  StripAffinity affinity{StripAffinity::shared};
+  StripPages pages{StripPages::standard};
+  bool prefault{false};
+};
+
+/// Stripool split into a partition of strips per NUMA node, with each
+/// partition's memory bound to its node, so that threads acquire memory that
+/// is local to them. Acquisitions are made from the partition of the node the
+/// calling thread is running on, falling back to the other nodes' partitions
+/// in turn when it has no room.
+///
+/// Each partition is a DynamicStripool, so acquisitions are released just as
+/// any other acquisition from a Stripool with the same bookkeeping, back to
+/// the partition they came from, whichever node releases them.
+///
+/// On systems with a single node, or without NUMA support, this is a single
+/// partition, with memory that is left to be placed as it is first touched.
+template <typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>>
+struct BasicNumaStripool
+{
+  using Partition = BasicDynamicStripool<Bookkeeping>;
+
+  /// Create a partition as described by the *config* for each node of the
+  /// *topology*. Throws as per DynamicStripool.
+  explicit BasicNumaStripool(const NumaStripoolConfig& config, NumaTopology topology = NumaTopology::system())
+    : topology_{std::move(topology)}
+  {
+    partitions_.reserve(topology_.node_count());
+    for ( std::size_t node = 0; node < topology_.node_count(); ++node ) {
+      partitions_.push_back(std::make_unique<Partition>(DynamicStripoolConfig{
+        .stripSize = config.stripSize,
+        .stripCount = config.stripsPerNode,
+        .layout = config.layout,
+        .affinity = config.affinity,
+        .pages = config.pages,
+        .prefault = config.prefault,
+        // A single node has nowhere else for the memory to go.
+        .node = topology_.node_count() > 1 ? static_cast<int>(node) : -1}));
+    }
+  }
+
+  BasicNumaStripool(const BasicNumaStripool&) = delete;
+  BasicNumaStripool& operator=(const BasicNumaStripool&) = delete;
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    const std::size_t home = topology_.current_node();
+    for ( std::size_t i = 0; i < partitions_.size(); ++i ) {
+      if ( char* acq = partitions_[(home + i) % partitions_.size()]->acquire(requested) ) {
+        return acq;
+      }
+    }
+    return nullptr;
+  }
+
+  static void release(char* mem) noexcept {
+    BasicStripool<Bookkeeping>::release(mem);
+  }
+
+  std::size_t node_count() const noexcept { return partitions_.size(); }
+
+  /// The partition of the *node*.
+  Partition& partition(std::size_t node) noexcept { return *partitions_[node]; }
+
+  const NumaTopology& topology() const noexcept { return topology_; }
+
+private:
+  const NumaTopology topology_;
+  std::vector<std::unique_ptr<Partition>> partitions_;
+};
+
+/// NumaStripool with the default bookkeeping.
+using NumaStripool = BasicNumaStripool<>;
+
+}
+
+#endif
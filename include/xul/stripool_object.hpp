@@ -0,0 +1,154 @@
+#ifndef _xul_stripool_object_hpp_
+#define _xul_stripool_object_hpp_
+
+#include "stripool.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace xul {
+
+/// Owning pointer to a *T* constructed in memory acquired from a stripool,
+/// which destroys the object and releases the memory when it goes out of
+/// scope, much as std::unique_ptr. Releasing is static for every stripool, so
+/// the pointer is all that is kept, and releases through the *Pool* type,
+/// which must be the pool acquired from, or a base of it.
+///
+/// Unlike std::unique_ptr, a pooled_ptr cannot point to a base of the object,
+/// since releasing needs the address that was acquired.
+template <typename T, typename Pool = Stripool>
+class pooled_ptr
+{
+public:
+  using element_type = T;
+  using pointer = T*;
+
+  constexpr pooled_ptr() noexcept = default;
+  constexpr pooled_ptr(std::nullptr_t) noexcept {}
+
+  /// Take ownership of the *object*, which must have been constructed at the
+  /// start of an acquisition from a *Pool*.
+  explicit pooled_ptr(T* object) noexcept : object_{object} {}
+
+  pooled_ptr(pooled_ptr&& other) noexcept : object_{std::exchange(other.object_, nullptr)} {}
+
+  /// Take ownership from a pointer whose pool is derived from *Pool*, as it
+  /// is released the same way.
+  template <typename Derived>
+    requires std::is_base_of_v<Pool, Derived>
+  pooled_ptr(pooled_ptr<T, Derived>&& other) noexcept : object_{other.release()} {}
+
+  pooled_ptr& operator=(pooled_ptr&& other) noexcept {
+    reset(other.release());
+    return *this;
+  }
+
+  pooled_ptr& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  ~pooled_ptr() { reset(); }
+
+  /// Destroy the object, if any, release its memory, and take ownership of
+  /// the *object* instead.
+  void reset(T* object = nullptr) noexcept {
+    T* old = std::exchange(object_, object);
+    if ( old ) {
+      std::destroy_at(old);
+      Pool::release(reinterpret_cast<char*>(old));
+    }
+  }
+
+  /// Give up ownership of the object, leaving the caller to destroy it and
+  /// release its memory.
+  [[nodiscard]] T* release() noexcept { return std::exchange(object_, nullptr); }
+
+  T* get() const noexcept { return object_; }
+  T& operator*() const noexcept { return *object_; }
+  T* operator->() const noexcept { return object_; }
+  explicit operator bool() const noexcept { return object_ != nullptr; }
+
+  friend bool operator==(const pooled_ptr& ptr, std::nullptr_t) noexcept { return !ptr; }
+
+private:
+  T* object_ = nullptr;
+};
+
+/// The pool that objects acquired from a *Pool* are released through, as
+/// *type*. For pools derived from a Stripool, that is the Stripool, so that
+/// pooled_ptrs to objects from any such pools are of the same type.
+template <typename Pool>
+struct StripoolReleaser
+{
+  using type = Pool;
+};
+
+template <typename Pool>
+  requires std::derived_from<Pool, BasicStripool<typename Pool::bookkeeping, typename Pool::stats_policy, typename Pool::occupancy_policy>>
+struct StripoolReleaser<Pool>
+{
+  using type = BasicStripool<typename Pool::bookkeeping, typename Pool::stats_policy, typename Pool::occupancy_policy>;
+};
+
+/// Constructs objects of type *T* in memory acquired from a *Pool*, handing
+/// them out as pooled_ptrs, so that they are destroyed and their memory
+/// released however their scope is left. Costs nothing beyond acquiring from
+/// the pool and constructing the object.
+template <typename T, typename Pool = Stripool>
+class StripoolObjectPool
+{
+public:
+  static_assert(sizeof(T) <= UINT32_MAX, "Objects must be small enough to acquire");
+
+  using pointer = pooled_ptr<T, typename StripoolReleaser<Pool>::type>;
+
+  explicit StripoolObjectPool(Pool& pool) noexcept : pool_{pool} {}
+
+  /// Construct a *T* from the *args*, in memory acquired from the pool.
+  /// Returns an empty pointer if the pool has no room. Should the
+  /// constructor throw, the memory is released before the exception
+  /// propagates.
+  template <typename... Args>
+  [[nodiscard]] pointer make(Args&&... args) {
+    char* mem;
+    if constexpr ( alignof(T) > alignof(std::max_align_t) ) {
+      mem = pool_.acquire(sizeof(T), alignof(T));
+    } else {
+      mem = pool_.acquire(sizeof(T));
+    }
+    if ( !mem ) {
+      return nullptr;
+    }
+    if constexpr ( std::is_nothrow_constructible_v<T, Args...> ) {
+      return pointer{::new (mem) T(std::forward<Args>(args)...)};
+    } else {
+      try {
+        return pointer{::new (mem) T(std::forward<Args>(args)...)};
+      } catch ( ... ) {
+        Pool::release(mem);
+        throw;
+      }
+    }
+  }
+
+  Pool& pool() const noexcept { return pool_; }
+
+private:
+  Pool& pool_;
+};
+
+/// Construct a *T* from the *args* in memory acquired from the *pool*, as
+/// StripoolObjectPool::make(), in place of std::make_unique.
+template <typename T, typename Pool, typename... Args>
+[[nodiscard]] auto make_pooled(Pool& pool, Args&&... args) {
+  return StripoolObjectPool<T, Pool>{pool}.make(std::forward<Args>(args)...);
+}
+
+}
+
+#endif
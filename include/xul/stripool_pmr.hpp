@@ -3,33 +3,98 @@
 
 #include "stripool.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory_resource>
+#include <new>
 
 namespace xul {
 
-struct StripoolMemoryResource : public std::pmr::memory_resource
+/// Memory resource that acquires from a stripool, for use with std::pmr
+/// containers.
+///
+/// Should the pool have no room, or the allocation be too large or too
+/// aligned to acquire, it overflows to the *upstream* resource, which by
+/// default throws std::bad_alloc. Deallocating tells the two apart by whether
+/// the memory lies in the pool's strips. Overflows are counted, to help with
+/// sizing the pool.
+///
+/// Resources compare equal when they can deallocate each other's memory,
+/// which is when their upstreams compare equal, and they either share a pool,
+/// or have nothing to overflow to, so that any memory that isn't in their own
+/// pool's strips is from another's, which any stripool can release. Containers
+/// can then be moved between resources, such as those of different threads,
+/// without copying.
+struct StripoolMemoryResource final : public std::pmr::memory_resource
 {
-  StripoolMemoryResource(Stripool& pool) : pool_{pool} {}
+  StripoolMemoryResource(
+    Stripool& pool,
+    std::pmr::memory_resource* upstream = std::pmr::null_memory_resource())
+    : pool_{pool}
+    , upstream_{upstream}
+  {}
 
   ~StripoolMemoryResource() override{}
 
+  std::pmr::memory_resource* upstream_resource() const noexcept { return upstream_; }
+
+  /// Number of allocations that overflowed to the upstream resource.
+  std::uint64_t overflows() const noexcept { return overflows_.load(std::memory_order_relaxed); }
 
 private:
-  void* do_allocate(std::size_t bytes, std::size_t /*alignment*/) override {
-    return pool_.acquire(bytes);
+  /// Whether the *other* resource is a StripoolMemoryResource too. Without
+  /// RTTI, that is told by the type tag that every polymorphic object starts
+  /// with, its vtable pointer, which as the class is final, only
+  /// StripoolMemoryResources have. Should a copy of the vtable from another
+  /// shared library not be merged with this one, resources merely compare
+  /// unequal.
+  bool isStripoolResource(const std::pmr::memory_resource& other) const noexcept {
+    const void* tag;
+    const void* otherTag;
+    std::memcpy(&tag, static_cast<const std::pmr::memory_resource*>(this), sizeof(tag));
+    std::memcpy(&otherTag, &other, sizeof(otherTag));
+    return tag == otherTag;
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if ( bytes <= UINT32_MAX ) {
+      if ( void* mem = pool_.acquire(static_cast<std::uint32_t>(bytes), alignment) ) {
+        return mem;
+      }
+    }
+    overflows_.fetch_add(1, std::memory_order_relaxed);
+    return upstream_->allocate(bytes, alignment);
   }
 
   void do_deallocate(void* p, std::size_t bytes, std::size_t alignment ) override {
-    return pool_.release(static_cast<char*>(p));
+    if ( pool_.owns(p) ) {
+      pool_.release(static_cast<char*>(p));
+    } else if ( upstream_ == std::pmr::null_memory_resource() ) {
+      // Nothing overflowed, so the memory is from an equal resource's pool.
+      Stripool::release(static_cast<char*>(p));
+    } else {
+      upstream_->deallocate(p, bytes, alignment);
+    }
   }
 
   bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
-    /// @todo Any stripool knows how to deallocate any other stripool's allocations,
-    /// so used a dynamic_cast check if RTTI is enabled.
-    return &other == this;
+    if ( &other == this ) {
+      return true;
+    }
+    if ( !isStripoolResource(other) ) {
+      return false;
+    }
+    // Laundered, as the compiler can't see how the type was found out.
+    const auto* resource = std::launder(static_cast<const StripoolMemoryResource*>(&other));
+    return upstream_->is_equal(*resource->upstream_)
+      && (&pool_ == &resource->pool_ || upstream_ == std::pmr::null_memory_resource());
   }
 
   Stripool& pool_;
+  std::pmr::memory_resource* upstream_;
+  std::atomic<std::uint64_t> overflows_{0};
 };
 
 }
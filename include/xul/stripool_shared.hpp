@@ -0,0 +1,344 @@
+#ifndef _xul_stripool_shared_hpp_
+#define _xul_stripool_shared_hpp_
+
+#include "stripool.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+namespace xul {
+
+/// Configuration of a SharedStripool, as given by the process creating it.
+struct SharedStripoolConfig
+{
+  /// The size of acquisition that every strip must be able to hold, as with
+  /// ArrayStripool's *strip_size_*.
+  std::size_t stripSize;
+  std::size_t stripCount;
+  StripLayout layout{StripLayout::interleaved};
+};
+
+/// Shared memory mapping that describes the stripool within it, in a header
+/// at the start of the mapping, so that other processes can attach to it
+/// knowing nothing but the file descriptor or name.
+class SharedStripMapping
+{
+public:
+  /// Space taken by the header at the start of the mapping, ahead of any
+  /// isolated strip headers and the strips.
+  static constexpr std::size_t header_size = 64;
+
+  /// Layout of the pool, as recorded in the header.
+  struct Header
+  {
+    std::uint64_t magic;
+    std::uint64_t rawStripSize;
+    std::uint64_t stripCount;
+    std::uint32_t layout;
+    /// The bookkeeping's word size and count bits, which every process must
+    /// agree on.
+    std::uint16_t wordSize;
+    std::uint16_t countBits;
+  };
+
+  static_assert(sizeof(Header) <= header_size);
+
+  /// Map *size* bytes of the shared memory of the *fd*, which is sized to
+  /// them, taking ownership of it. Throws std::system_error if the memory
+  /// could not be sized or mapped.
+  SharedStripMapping(int fd, std::size_t size)
+    : fd_{fd}
+  {
+    if ( ::ftruncate(fd_, static_cast<off_t>(size)) != 0 ) {
+      const int error = errno;
+      ::close(fd_);
+      throw std::system_error{error, std::generic_category(), "Failed to size shared stripool memory"};
+    }
+    map(size);
+  }
+
+  /// Map all of the existing shared memory of the *fd*, taking ownership of
+  /// it. Throws std::system_error if the memory could not be mapped.
+  explicit SharedStripMapping(int fd)
+    : fd_{fd}
+  {
+    struct stat st;
+    if ( ::fstat(fd_, &st) != 0 ) {
+      const int error = errno;
+      ::close(fd_);
+      throw std::system_error{error, std::generic_category(), "Failed to stat shared stripool memory"};
+    }
+    if ( static_cast<std::size_t>(st.st_size) < header_size ) {
+      ::close(fd_);
+      throw std::invalid_argument{"Shared memory does not hold a stripool"};
+    }
+    map(st.st_size);
+  }
+
+  ~SharedStripMapping() {
+    ::munmap(data_, size_);
+    ::close(fd_);
+  }
+
+  SharedStripMapping(const SharedStripMapping&) = delete;
+  SharedStripMapping& operator=(const SharedStripMapping&) = delete;
+
+  char* data() const noexcept { return data_; }
+  std::size_t size() const noexcept { return size_; }
+  int fd() const noexcept { return fd_; }
+  Header& header() const noexcept { return *reinterpret_cast<Header*>(data_); }
+
+  /// The header's magic, which is only stored once the pool is set up, so
+  /// that processes attaching don't use it half set up.
+  std::atomic_ref<std::uint64_t> magic() const noexcept { return std::atomic_ref{header().magic}; }
+
+  static constexpr std::uint64_t magic_value = 0x6c6f6f7069727473; // "stripool"
+
+private:
+  void map(std::size_t size) {
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if ( mapped == MAP_FAILED ) {
+      const int error = errno;
+      ::close(fd_);
+      throw std::system_error{error, std::generic_category(), "Failed to map shared stripool memory"};
+    }
+    data_ = static_cast<char*>(mapped);
+    size_ = size;
+  }
+
+  int fd_;
+  char* data_;
+  std::size_t size_;
+};
+
+/// Stripool in memory shared between processes, for passing acquisitions
+/// between them without copying. One process creates the pool, in anonymous
+/// shared memory from memfd_create(), whose file descriptor other processes
+/// inherit or are sent, or in POSIX shared memory with a name, and other
+/// processes attach to it. Any process can acquire, and any process can
+/// release what was acquired by any other.
+///
+/// Each process maps the memory wherever it lands, so acquisitions are
+/// preceeded by the offset of their strip within the mapping, rather than a
+/// pointer to it, and are passed between processes as offsets, with
+/// offset_of() and at(). Releasing needs the mapping to find the strip, so
+/// is done through the pool, rather than being static.
+///
+/// The bookkeeping atomics are lock free, so work across processes. Waiting
+/// for memory is not supported, as strips don't point back to a pool, which
+/// would be in only one process. Pools can't record stats for the same reason.
+template <typename Bookkeeping = StripBookkeeping<std::uint32_t, 8>>
+struct BasicSharedStripool : private SharedStripMapping, private BasicStripool<Bookkeeping>
+{
+  using bookkeeping = Bookkeeping;
+
+  /// Create a pool as described by the *config*, in anonymous shared memory,
+  /// which other processes attach to through fd(). Throws
+  /// std::invalid_argument if the configuration cannot be catered for by the
+  /// bookkeeping, and std::system_error if the memory cannot be created or
+  /// mapped.
+  explicit BasicSharedStripool(const SharedStripoolConfig& config, StripAffinity affinity = StripAffinity::shared)
+    : BasicSharedStripool{createMemfd(validated(config)), config, affinity}
+  {}
+
+  /// Create a pool as described by the *config*, in POSIX shared memory
+  /// named *name*, which must not already exist, and which other processes
+  /// attach to by name. The name stays until unlink() is called with it.
+  /// Throws as for anonymous shared memory.
+  BasicSharedStripool(const char* name, const SharedStripoolConfig& config, StripAffinity affinity = StripAffinity::shared)
+    : BasicSharedStripool{createShm(name, validated(config)), config, affinity}
+  {}
+
+  /// Attach to the pool in the shared memory of the *fd*, which is
+  /// duplicated, so stays the caller's. Throws std::invalid_argument if the
+  /// memory does not hold a pool with the same bookkeeping, and
+  /// std::system_error if it cannot be mapped.
+  explicit BasicSharedStripool(int fd, StripAffinity affinity = StripAffinity::shared)
+    : BasicSharedStripool{Attach{dupFd(fd)}, affinity}
+  {}
+
+  /// Attach to the pool in the POSIX shared memory named *name*. Throws as
+  /// for attaching through a file descriptor.
+  explicit BasicSharedStripool(const char* name, StripAffinity affinity = StripAffinity::shared)
+    : BasicSharedStripool{Attach{openShm(name)}, affinity}
+  {}
+
+  /// Remove the POSIX shared memory *name*, which lives on until every
+  /// process has detached from it.
+  static void unlink(const char* name) noexcept { ::shm_unlink(name); }
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    requested += sizeof(SharedStripPtr);
+    requested = (requested + alignof(SharedStripPtr) - 1) & ~(alignof(SharedStripPtr) - 1);
+    const auto claimed = this->claim(requested);
+    if ( !claimed.mem ) {
+      return nullptr;
+    }
+    const std::size_t end = claimed.head + requested;
+    const bool kept = end <= UINT32_MAX;
+    SharedStripPtr* ptr = reinterpret_cast<SharedStripPtr*>(claimed.mem);
+    ptr->strip = reinterpret_cast<char*>(claimed.strip) - data();
+    ptr->begin = kept ? static_cast<std::uint32_t>(claimed.begin) : 0;
+    ptr->end = kept ? static_cast<std::uint32_t>(end) : 0;
+    return claimed.mem + sizeof(SharedStripPtr);
+  }
+
+  /// Release the *mem*, which may have been acquired by any process attached
+  /// to the pool.
+  void release(char* mem) noexcept {
+    const SharedStripPtr* ptr = reinterpret_cast<const SharedStripPtr*>(mem - sizeof(SharedStripPtr));
+    base::releaseStrip(reinterpret_cast<StripHdr*>(data() + ptr->strip), first_head, 1, ptr->begin, ptr->end);
+  }
+
+  /// Offset of the *mem* within the shared memory, which is the same for
+  /// every process.
+  std::size_t offset_of(const char* mem) const noexcept { return mem - data(); }
+  /// Memory at the *offset* within the shared memory, in this process.
+  char* at(std::size_t offset) const noexcept { return data() + offset; }
+
+  /// File descriptor of the shared memory, for other processes to attach
+  /// through. It is closed when the pool is destroyed.
+  using SharedStripMapping::fd;
+  /// Size of the shared memory.
+  std::size_t mapped_size() const noexcept { return SharedStripMapping::size(); }
+
+private:
+  using base = BasicStripool<Bookkeeping>;
+  using typename base::StripHdr;
+  using base::first_head;
+
+  // Every acquisition is prefixed with the offset of its strip, and the heads
+  // it spans, as with a StripPtr.
+  struct alignas(std::max_align_t) SharedStripPtr {
+    std::uint64_t strip;
+    std::uint32_t begin;
+    std::uint32_t end;
+  };
+
+  static_assert(sizeof(SharedStripPtr) == base::stripptr_size);
+  static_assert(std::atomic<typename Bookkeeping::word_type>::is_always_lock_free);
+
+  struct Attach
+  {
+    int fd;
+  };
+
+  BasicSharedStripool(int fd, const SharedStripoolConfig& config, StripAffinity affinity)
+    : SharedStripMapping{fd, mappingSize(rawStripSize(config.stripSize, config.layout), config.stripCount, config.layout)}
+    , base{
+        rawStripSize(config.stripSize, config.layout),
+        config.stripCount,
+        SharedStripMapping::data() + header_size + headersSize(config.stripCount, config.layout),
+        config.layout == StripLayout::isolated ? SharedStripMapping::data() + header_size : nullptr,
+        affinity}
+  {
+    Header& header = SharedStripMapping::header();
+    header.rawStripSize = rawStripSize(config.stripSize, config.layout);
+    header.stripCount = config.stripCount;
+    header.layout = static_cast<std::uint32_t>(config.layout);
+    header.wordSize = sizeof(typename Bookkeeping::word_type);
+    header.countBits = Bookkeeping::count_bits;
+    base::detachStrips();
+    magic().store(magic_value, std::memory_order_release);
+  }
+
+  BasicSharedStripool(Attach attach, StripAffinity affinity)
+    : SharedStripMapping{attach.fd}
+    , base{
+        validated(*this).header().rawStripSize,
+        header().stripCount,
+        SharedStripMapping::data() + header_size + headersSize(header().stripCount, StripLayout(header().layout)),
+        StripLayout(header().layout) == StripLayout::isolated ? SharedStripMapping::data() + header_size : nullptr,
+        affinity,
+        first_head,
+        true}
+  {}
+
+  static std::size_t rawStripSize(std::size_t stripSize, StripLayout layout) {
+    return base::raw_strip_size_for(stripSize, layout);
+  }
+
+  static std::size_t headersSize(std::size_t stripCount, StripLayout layout) {
+    return layout == StripLayout::isolated ? base::isolated_striphdr_size * stripCount : 0;
+  }
+
+  static std::size_t mappingSize(std::size_t rawStripSize, std::size_t stripCount, StripLayout layout) {
+    return header_size + headersSize(stripCount, layout) + rawStripSize * stripCount;
+  }
+
+  static const SharedStripoolConfig& validated(const SharedStripoolConfig& config) {
+    if ( config.stripCount == 0 ) {
+      throw std::invalid_argument{"Stripool must have at least one strip"};
+    }
+    const std::size_t isolatedHdr = config.layout == StripLayout::isolated ? first_head : 0;
+    if ( rawStripSize(config.stripSize, config.layout) + isolatedHdr > Bookkeeping::max_strip_size ) {
+      throw std::invalid_argument{"Strips are too large for the bookkeeping to keep track of"};
+    }
+    return config;
+  }
+
+  /// Check that the attached *mapping* holds a pool this pool can use.
+  static const SharedStripMapping& validated(const SharedStripMapping& mapping) {
+    const Header& header = mapping.header();
+    if ( mapping.magic().load(std::memory_order_acquire) != magic_value ) {
+      throw std::invalid_argument{"Shared memory does not hold a stripool"};
+    }
+    if ( header.wordSize != sizeof(typename Bookkeeping::word_type) || header.countBits != Bookkeeping::count_bits ) {
+      throw std::invalid_argument{"Shared stripool has different bookkeeping"};
+    }
+    if ( header.layout > static_cast<std::uint32_t>(StripLayout::isolated)
+        || header.stripCount == 0
+        || mapping.size() < mappingSize(header.rawStripSize, header.stripCount, StripLayout(header.layout)) ) {
+      throw std::invalid_argument{"Shared stripool is malformed"};
+    }
+    return mapping;
+  }
+
+  static int createMemfd(const SharedStripoolConfig&) {
+    const int fd = ::memfd_create("stripool", MFD_CLOEXEC);
+    if ( fd < 0 ) {
+      throw std::system_error{errno, std::generic_category(), "Failed to create shared stripool memory"};
+    }
+    return fd;
+  }
+
+  static int createShm(const char* name, const SharedStripoolConfig&) {
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if ( fd < 0 ) {
+      throw std::system_error{errno, std::generic_category(), "Failed to create shared stripool memory"};
+    }
+    return fd;
+  }
+
+  static int openShm(const char* name) {
+    const int fd = ::shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if ( fd < 0 ) {
+      throw std::system_error{errno, std::generic_category(), "Failed to open shared stripool memory"};
+    }
+    return fd;
+  }
+
+  static int dupFd(int fd) {
+    const int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if ( dup < 0 ) {
+      throw std::system_error{errno, std::generic_category(), "Failed to duplicate shared stripool memory"};
+    }
+    return dup;
+  }
+};
+
+/// SharedStripool with the default bookkeeping.
+using SharedStripool = BasicSharedStripool<>;
+
+}
+
+#endif
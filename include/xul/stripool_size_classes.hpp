@@ -0,0 +1,129 @@
+#ifndef _xul_stripool_size_classes_hpp_
+#define _xul_stripool_size_classes_hpp_
+
+#include "stripool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+namespace xul {
+
+/// A size class of a SizeClassStripool, for acquisitions of up to *size_*
+/// bytes, from a pool of *strip_count_* strips, each capable of holding at
+/// least 1 *strip_size_* byte allocation, as with ArrayStripool.
+template <std::uint32_t size_, std::size_t strip_size_, std::size_t strip_count_>
+struct StripSizeClass
+{
+  static constexpr std::uint32_t size = size_;
+  static constexpr std::size_t strip_size = strip_size_;
+  static constexpr std::size_t strip_count = strip_count_;
+
+  static_assert(size_ > 0 && size_ <= strip_size_, "Strips must hold at least 1 acquisition of the class");
+};
+
+/// Front-end to several ArrayStripools, one per size class, that sends each
+/// acquisition to the pool of the smallest class that it fits. This suits
+/// workloads with a wide range of acquisition sizes, where a single pool must
+/// be sized for the largest, and a few small long lived acquisitions can keep
+/// strips from being reset that larger acquisitions need.
+///
+/// The *classes_* are StripSizeClasses, in ascending order of size, with
+/// sizes that are multiples of size_granularity. The class an acquisition
+/// goes to is looked up in a table computed at compile time, indexed by the
+/// acquisition size in units of size_granularity. Should a class's pool be
+/// exhausted, the acquisition spills over to the following larger classes.
+///
+/// Every class's pool uses the same *Bookkeeping*, so acquisitions are
+/// released just as any other acquisition from a Stripool with that
+/// bookkeeping, and go back to the pool they came from.
+///
+/// Since the pools' memory is embedded, these are typically large, so are
+/// best given static or heap storage duration.
+template <typename Bookkeeping, typename... classes_>
+struct BasicSizeClassStripool
+{
+  static constexpr std::size_t class_count = sizeof...(classes_);
+  /// Acquisition sizes are looked up in units of this many bytes.
+  static constexpr std::uint32_t size_granularity = 8;
+  /// The largest acquisition, which is the size of the largest class.
+  static constexpr std::uint32_t max_size = std::max({classes_::size...});
+
+  static_assert(class_count > 0 && class_count <= 255, "Pools must have between 1 and 255 size classes");
+  static_assert(((classes_::size % size_granularity == 0) && ...), "Class sizes must be multiples of size_granularity");
+  static_assert(
+    []{
+      const std::array sizes{classes_::size...};
+      return std::ranges::adjacent_find(sizes, std::ranges::greater_equal{}) == sizes.end();
+    }(),
+    "Classes must be in ascending order of size");
+
+  explicit BasicSizeClassStripool(StripAffinity affinity = StripAffinity::shared)
+    : pools_{(void(sizeof(classes_)), affinity)...}
+    , classPools_{std::apply([](auto&... pools){ return std::array<base*, class_count>{&pools...}; }, pools_)}
+  {}
+
+  BasicSizeClassStripool(const BasicSizeClassStripool&) = delete;
+  BasicSizeClassStripool& operator=(const BasicSizeClassStripool&) = delete;
+
+  /// Acquire from the pool of the smallest class the *requested* bytes fit,
+  /// or a larger class if that pool is exhausted. Returns nullptr if no class
+  /// has room, or the *requested* size is larger than max_size.
+  [[nodiscard]] char* acquire(std::uint32_t requested) noexcept {
+    if ( requested > max_size ) {
+      return nullptr;
+    }
+    for ( std::size_t i = class_table[(requested + size_granularity - 1) / size_granularity]; i < class_count; ++i ) {
+      if ( char* acq = classPools_[i]->acquire(requested) ) {
+        return acq;
+      }
+    }
+    return nullptr;
+  }
+
+  static void release(char* mem) {
+    base::release(mem);
+  }
+
+  /// The class that a *requested* size of acquisition first goes to.
+  static constexpr std::size_t class_for(std::uint32_t requested) {
+    return class_table[(requested + size_granularity - 1) / size_granularity];
+  }
+
+  /// The pool of the *class_*th size class.
+  template <std::size_t class_>
+  auto& class_pool() noexcept { return std::get<class_>(pools_); }
+
+private:
+  using base = BasicStripool<Bookkeeping>;
+
+  // Index of the smallest class that fits each size, in units of the
+  // granularity, up to the largest class.
+  static constexpr auto class_table = []{
+    const std::array sizes{classes_::size...};
+    std::array<std::uint8_t, max_size / size_granularity + 1> table{};
+    std::uint8_t cls = 0;
+    for ( std::size_t i = 0; i < table.size(); ++i ) {
+      while ( sizes[cls] < i * size_granularity ) {
+        ++cls;
+      }
+      table[i] = cls;
+    }
+    return table;
+  }();
+
+  std::tuple<ArrayStripool<classes_::strip_size, classes_::strip_count, StripLayout::interleaved, Bookkeeping>...> pools_;
+  // The pools by class index, for looking up without knowing the class at
+  // compile time.
+  const std::array<base*, class_count> classPools_;
+};
+
+/// SizeClassStripool with the default bookkeeping.
+template <typename... classes_>
+using SizeClassStripool = BasicSizeClassStripool<StripBookkeeping<std::uint32_t, 8>, classes_...>;
+
+}
+
+#endif
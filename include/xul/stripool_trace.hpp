@@ -0,0 +1,249 @@
+#ifndef _xul_stripool_trace_hpp_
+#define _xul_stripool_trace_hpp_
+
+#include "stripool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace xul {
+
+/// An acquisition or release in a trace of a stripool's use. Fields are wide
+/// enough that they don't wrap, however long the trace.
+struct StripTraceEvent
+{
+  /// Size of release events, which no acquisition can have asked for.
+  static constexpr std::uint32_t release_size = UINT32_MAX;
+
+  /// Nanoseconds since the trace started.
+  std::uint64_t nanos;
+  /// Identifies an acquisition, and its release. Ids are handed out in order
+  /// from 0, including to acquisitions that failed, which are never released.
+  std::uint64_t lifetime;
+  /// Size asked for by an acquisition, or release_size.
+  std::uint32_t size;
+  /// Slot of the thread, as per stripool_thread_slot(), modulo 2^16.
+  std::uint16_t thread;
+  /// Whether the acquisition failed, leaving the caller to make do without.
+  bool failed;
+
+  bool is_release() const noexcept { return size == release_size; }
+};
+
+static_assert(sizeof(StripTraceEvent) == 24);
+
+/// Start of every trace, which identifies the format and its version.
+/// Events follow, as they are laid out in memory, so traces are only read on
+/// the platform they were written on.
+inline constexpr char strip_trace_magic[8] = {'x', 'u', 'l', 's', 't', 'r', 'p', '1'};
+
+/// Writes a trace of StripTraceEvents to a stream, as they are recorded by
+/// any number of threads. Events are buffered, and written in batches, under
+/// a lock, which is taken for every event, so tracing suits finding out how
+/// a pool is used rather than being left on.
+class StripTraceWriter
+{
+public:
+  static constexpr std::size_t batch_events = 4096;
+
+  explicit StripTraceWriter(std::ostream& out)
+    : out_{out}
+    , start_{std::chrono::steady_clock::now()}
+  {
+    out_.write(strip_trace_magic, sizeof(strip_trace_magic));
+    batch_.reserve(batch_events);
+  }
+
+  StripTraceWriter(const StripTraceWriter&) = delete;
+  StripTraceWriter& operator=(const StripTraceWriter&) = delete;
+
+  ~StripTraceWriter() { flush(); }
+
+  /// Record an acquisition of *size* that returned *mem*, which is nullptr
+  /// if it failed.
+  void acquired(const char* mem, std::uint32_t size) {
+    const std::scoped_lock lock{mutex_};
+    const std::uint64_t lifetime = nextLifetime_++;
+    if ( mem ) {
+      live_[mem] = lifetime;
+    }
+    record(lifetime, std::min(size, StripTraceEvent::release_size - 1), !mem);
+  }
+
+  /// Record the release of *mem*, which must be recorded before it is
+  /// released, lest it be acquired again in the meantime.
+  void releasing(const char* mem) {
+    const std::scoped_lock lock{mutex_};
+    const auto acq = live_.find(mem);
+    if ( acq == live_.end() ) {
+      return;
+    }
+    record(acq->second, StripTraceEvent::release_size, false);
+    live_.erase(acq);
+  }
+
+  /// Write out any events recorded since the last batch.
+  void flush() {
+    const std::scoped_lock lock{mutex_};
+    writeBatch();
+    out_.flush();
+  }
+
+private:
+  /// Record an event, with the lock held.
+  void record(std::uint64_t lifetime, std::uint32_t size, bool failed) {
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_).count();
+    batch_.push_back(StripTraceEvent{
+      .nanos = static_cast<std::uint64_t>(nanos),
+      .lifetime = lifetime,
+      .size = size,
+      .thread = static_cast<std::uint16_t>(stripool_thread_slot()),
+      .failed = failed});
+    if ( batch_.size() == batch_events ) {
+      writeBatch();
+    }
+  }
+
+  void writeBatch() {
+    out_.write(reinterpret_cast<const char*>(batch_.data()), batch_.size() * sizeof(StripTraceEvent));
+    batch_.clear();
+  }
+
+  std::mutex mutex_;
+  std::ostream& out_;
+  const std::chrono::steady_clock::time_point start_;
+  std::uint64_t nextLifetime_{0};
+  std::unordered_map<const char*, std::uint64_t> live_;
+  std::vector<StripTraceEvent> batch_;
+};
+
+/// Stripool that records every acquisition and release made through it to a
+/// trace, for replaying against other pool configurations with
+/// replay_strip_trace(). Acquisitions must be released through the tracing
+/// pool for their releases to be recorded.
+template <typename Pool = Stripool>
+class TracingStripool
+{
+public:
+  TracingStripool(Pool& pool, std::ostream& out)
+    : pool_{pool}
+    , writer_{out}
+  {}
+
+  [[nodiscard]] char* acquire(std::uint32_t requested) {
+    char* mem = pool_.acquire(requested);
+    writer_.acquired(mem, requested);
+    return mem;
+  }
+
+  void release(char* mem) {
+    writer_.releasing(mem);
+    Pool::release(mem);
+  }
+
+  /// Write out the events recorded so far, as happens anyway when the
+  /// tracing pool is destroyed.
+  void flush() { writer_.flush(); }
+
+  Pool& pool() const noexcept { return pool_; }
+
+private:
+  Pool& pool_;
+  StripTraceWriter writer_;
+};
+
+/// Read a whole trace written by a StripTraceWriter from the *in* stream.
+/// Throws std::invalid_argument if it isn't a trace, or is cut short.
+inline std::vector<StripTraceEvent> read_strip_trace(std::istream& in)
+{
+  char magic[sizeof(strip_trace_magic)];
+  if ( !in.read(magic, sizeof(magic)) || std::memcmp(magic, strip_trace_magic, sizeof(magic)) != 0 ) {
+    throw std::invalid_argument{"Not a stripool trace"};
+  }
+  std::vector<StripTraceEvent> events;
+  StripTraceEvent event;
+  while ( in.read(reinterpret_cast<char*>(&event), sizeof(event)) ) {
+    events.push_back(event);
+  }
+  if ( in.gcount() != 0 ) {
+    throw std::invalid_argument{"Stripool trace is truncated"};
+  }
+  return events;
+}
+
+/// Outcome of replaying a trace against a pool.
+struct StripTraceReplay
+{
+  std::size_t acquires = 0;
+  /// Acquisitions that the pool had no room for.
+  std::size_t failures = 0;
+  /// The most strips holding acquisitions at once.
+  std::size_t peakStripsInUse = 0;
+  /// Time taken to replay the trace, including keeping track of the strips.
+  std::chrono::nanoseconds duration{0};
+
+  double failure_rate() const noexcept {
+    return acquires ? double(failures) / double(acquires) : 0;
+  }
+};
+
+/// Replay the *events* of a trace against the *pool*, which may be any
+/// ArrayStripool or DynamicStripool, to see how it would have coped. Events
+/// are replayed in the order they were recorded, from the calling thread, as
+/// fast as it can, so the pool sees the same acquisitions live at once as the
+/// traced pool did, but none of the contention. Acquisitions that failed when
+/// traced have no release, as the caller made do without, so are released
+/// straight away should they succeed. Anything still acquired at the end is
+/// released, leaving the pool as it was.
+template <typename Pool>
+StripTraceReplay replay_strip_trace(const std::vector<StripTraceEvent>& events, Pool& pool)
+{
+  StripTraceReplay replay;
+  std::unordered_map<std::uint64_t, char*> live;
+  std::vector<std::uint32_t> stripCounts(pool.strip_count());
+  std::size_t stripsInUse = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for ( const StripTraceEvent& event : events ) {
+    if ( !event.is_release() ) {
+      ++replay.acquires;
+      char* mem = pool.acquire(event.size);
+      if ( !mem ) {
+        ++replay.failures;
+      } else if ( event.failed ) {
+        Pool::release(mem);
+      } else {
+        live.emplace(event.lifetime, mem);
+        if ( stripCounts[pool.strip_index(mem)]++ == 0 ) {
+          replay.peakStripsInUse = std::max(replay.peakStripsInUse, ++stripsInUse);
+        }
+      }
+    } else if ( const auto acq = live.find(event.lifetime); acq != live.end() ) {
+      if ( --stripCounts[pool.strip_index(acq->second)] == 0 ) {
+        --stripsInUse;
+      }
+      Pool::release(acq->second);
+      live.erase(acq);
+    }
+  }
+  replay.duration = std::chrono::steady_clock::now() - start;
+
+  for ( const auto& [lifetime, mem] : live ) {
+    Pool::release(mem);
+  }
+  return replay;
+}
+
+}
+
+#endif
@@ -2,20 +2,46 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <vector>
 #include <cstdio>
 #include <ranges>
 #include <cstring>
 
-TEST(Stripool, X)
+// Every bookkeeping configuration should behave the same for small strips.
+template <typename Bookkeeping>
+struct Stripool : public ::testing::Test
 {
-  xul::ArrayStripool<16, 3> pool;
+  template <
+    std::size_t strip_size_,
+    std::size_t strip_count_,
+    xul::StripLayout layout_ = xul::StripLayout::interleaved>
+  using ArrayStripool = xul::ArrayStripool<strip_size_, strip_count_, layout_, Bookkeeping>;
+};
+
+using Bookkeepings = ::testing::Types<
+  xul::StripBookkeeping<std::uint32_t, 8>,
+  xul::StripBookkeeping<std::uint32_t, 16>,
+  xul::StripBookkeeping<std::uint64_t, 16>,
+  xul::StripBookkeeping<std::uint64_t, 32>>;
+TYPED_TEST_SUITE(Stripool, Bookkeepings);
+
+TYPED_TEST(Stripool, X)
+{
+  typename TestFixture::template ArrayStripool<16, 3> pool;
   static_assert(pool.raw_strip_size() % alignof(std::max_align_t) == 0);
   auto acq1 = pool.acquire(16);
   EXPECT_NE(acq1, nullptr);
-  // The pointer isn't aligned as I'd expect. The StripHdr is 8-bytes not 16.
-  // Probably better off just doing the correct alignment.
-  EXPECT_EQ(acq1, (char*)pool.memory() + 8 + 16) << "Difference is: " << std::distance<char*>((char*)pool.memory(), acq1);
+  // The header is padded out so that, after the pointer back to the strip,
+  // the acquisition is max aligned.
+  EXPECT_EQ(acq1, (char*)pool.memory() + 16 + 16) << "Difference is: " << std::distance<char*>((char*)pool.memory(), acq1);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(acq1) % alignof(std::max_align_t), 0);
   std::fill_n(acq1, 16, 'a');
 
   auto acq2 = pool.acquire(16);
@@ -39,12 +65,12 @@ TEST(Stripool, X)
   }
 }
 
-TEST(Stripool, MultipleAllocationsPerStrip)
+TYPED_TEST(Stripool, MultipleAllocationsPerStrip)
 {
   // Hold just under 3 maximally aligned objects per strip. Each allocation
   // has a max aligned pointer preceeding it, so this will only allow 2
   // per strip.
-  xul::ArrayStripool<sizeof(std::max_align_t) * 3 - 1, 3> pool;
+  typename TestFixture::template ArrayStripool<sizeof(std::max_align_t) * 3 - 1, 3> pool;
   for ( int goes = 0; goes < 10; ++goes ) {
     std::vector<char*> acqs;
     for ( int i = 0; i < 6; ++i ) {
@@ -64,17 +90,13 @@ TEST(Stripool, MultipleAllocationsPerStrip)
 
 }
 
-bool fillbo_faggins(xul::Stripool& pool, int threadId)
+bool fillbo_faggins(auto& pool, int threadId)
 {
   std::array<char, 8> expected{};
   expected.fill(threadId);
 
   for (int runs = 0; runs != 1'000'000; ++runs ) {
-    char* acq = nullptr;
-    while (!acq) {
-      //std::this_thread::yield();
-      acq = pool.acquire(8);
-    }
+    char* acq = pool.acquire_wait(8);
     // Repeatedly fill the acquisition with our thread ID
     for ( int fillAttempt = 0; fillAttempt < 1'000; ++fillAttempt ) {
       std::fill_n(acq, 8, threadId);
@@ -92,20 +114,611 @@ bool fillbo_faggins(xul::Stripool& pool, int threadId)
   return false;
 }
 
-// Not recommended to run this on debug. It takes forever.
-TEST(Stripool, DISABLED_Swarm)
+TYPED_TEST(Stripool, IsolatedHeaders)
+{
+  // With the headers kept apart, the strips hold nothing but acquisitions,
+  // each preceeded by its pointer back to the strip header.
+  using Pool = typename TestFixture::template ArrayStripool<16, 3, xul::StripLayout::isolated>;
+  Pool pool;
+  static_assert(Pool::raw_strip_size() < TestFixture::template ArrayStripool<16, 3>::raw_strip_size());
+  auto acq1 = pool.acquire(16);
+  EXPECT_EQ(acq1, (char*)pool.memory() + alignof(std::max_align_t));
+  std::fill_n(acq1, 16, 'a');
+
+  auto acq2 = pool.acquire(16);
+  EXPECT_EQ(acq2, acq1 + Pool::raw_strip_size());
+  std::fill_n(acq2, 16, 'b');
+
+  auto acq3 = pool.acquire(16);
+  EXPECT_EQ(acq3, acq2 + Pool::raw_strip_size());
+  std::fill_n(acq3, 16, 'c');
+
+  EXPECT_EQ(pool.acquire(16), nullptr);
+
+  pool.release(acq2);
+  EXPECT_EQ(pool.acquire(16), acq2);
+  pool.release(acq1);
+  pool.release(acq2);
+  pool.release(acq3);
+}
+
+TYPED_TEST(Stripool, ThreadAffinity)
+{
+  // A single thread always starts at its own strip, so keeps getting the
+  // same memory back, and only spills into the other strips when its own
+  // strip is full.
+  typename TestFixture::template ArrayStripool<16, 3> pool{xul::StripAffinity::thread};
+  auto acq1 = pool.acquire(16);
+  ASSERT_NE(acq1, nullptr);
+  pool.release(acq1);
+  EXPECT_EQ(pool.acquire(16), acq1);
+
+  auto acq2 = pool.acquire(16);
+  auto acq3 = pool.acquire(16);
+  EXPECT_NE(acq2, nullptr);
+  EXPECT_NE(acq3, nullptr);
+  EXPECT_EQ(pool.acquire(16), nullptr);
+
+  // With its own strip still full, the thread spills into the next strip.
+  pool.release(acq2);
+  pool.release(acq3);
+  auto acq4 = pool.acquire(16);
+  EXPECT_EQ(acq4, acq2);
+  pool.release(acq4);
+  pool.release(acq1);
+  EXPECT_EQ(pool.acquire(16), acq1);
+}
+
+TYPED_TEST(Stripool, AcquireWait)
+{
+  typename TestFixture::template ArrayStripool<16, 2> pool;
+  auto acq1 = pool.acquire_wait(16);
+  auto acq2 = pool.acquire_wait(16);
+  ASSERT_NE(acq1, nullptr);
+  ASSERT_NE(acq2, nullptr);
+
+  // The pool is exhausted, so the waiting thread is parked until the release
+  // resets a strip.
+  std::atomic<bool> released{false};
+  std::thread waiter{[&]{
+    auto acq = pool.acquire_wait(16);
+    EXPECT_TRUE(released);
+    EXPECT_EQ(acq, acq2);
+    pool.release(acq);
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  released = true;
+  pool.release(acq2);
+  waiter.join();
+  pool.release(acq1);
+}
+
+TYPED_TEST(Stripool, AcquireFor)
+{
+  typename TestFixture::template ArrayStripool<16, 1> pool;
+  auto acq1 = pool.acquire_for(16, std::chrono::seconds{1});
+  ASSERT_NE(acq1, nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(pool.acquire_for(16, std::chrono::milliseconds{20}), nullptr);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{20});
+
+  std::thread releaser{[&]{
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    pool.release(acq1);
+  }};
+  auto acq2 = pool.acquire_for(16, std::chrono::seconds{10});
+  EXPECT_EQ(acq2, acq1);
+  releaser.join();
+  pool.release(acq2);
+}
+
+namespace {
+
+/// Coroutine that runs eagerly, and is never awaited.
+struct Detached
+{
+  struct promise_type
+  {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+Detached acquireAsync(auto& pool, std::uint32_t size, char*& acq, auto... executor)
+{
+  acq = co_await pool.async_acquire(size, executor...);
+}
+
+}
+
+TYPED_TEST(Stripool, AsyncAcquire)
 {
-  xul::ArrayStripool<32, 12> pool;
-  bool overlap{false};
+  typename TestFixture::template ArrayStripool<16, 2> pool;
+  char* acq1 = nullptr;
+  char* acq2 = nullptr;
+  acquireAsync(pool, 16, acq1);
+  acquireAsync(pool, 16, acq2);
+  ASSERT_NE(acq1, nullptr);
+  ASSERT_NE(acq2, nullptr);
+
+  // The pool is exhausted, so the coroutines are suspended, until a release
+  // resumes them, in the order they can acquire.
+  char* acq3 = nullptr;
+  char* acq4 = nullptr;
+  acquireAsync(pool, 16, acq3);
+  acquireAsync(pool, 16, acq4);
+  EXPECT_EQ(acq3, nullptr);
+  EXPECT_EQ(acq4, nullptr);
+
+  pool.release(acq2);
+  EXPECT_EQ(acq2, acq3 ? acq3 : acq4);
+  EXPECT_TRUE((acq3 == nullptr) != (acq4 == nullptr));
+  pool.release(acq1);
+  EXPECT_NE(acq3, nullptr);
+  EXPECT_NE(acq4, nullptr);
+  pool.release(acq3);
+  pool.release(acq4);
+}
+
+TYPED_TEST(Stripool, AsyncAcquireExecutor)
+{
+  typename TestFixture::template ArrayStripool<16, 1> pool;
+  std::deque<std::coroutine_handle<>> queue;
+  auto executor = [&queue](std::coroutine_handle<> handle) { queue.push_back(handle); };
+
+  char* acq1 = nullptr;
+  char* acq2 = nullptr;
+  acquireAsync(pool, 16, acq1, executor);
+  acquireAsync(pool, 16, acq2, executor);
+  ASSERT_NE(acq1, nullptr);
+  EXPECT_TRUE(queue.empty());
+
+  // The release hands the coroutine to the executor rather than resuming it.
+  pool.release(acq1);
+  ASSERT_EQ(queue.size(), 1);
+  EXPECT_EQ(acq2, nullptr);
+  queue.front().resume();
+  EXPECT_EQ(acq2, acq1);
+  pool.release(acq2);
+}
+
+TEST(StripParking, AsyncBackpressure)
+{
+  // Threads releasing to a tiny pool have the coroutines waiting on it passed
+  // between them, with none of them ever left suspended.
+  xul::ArrayStripool<8, 2> pool;
+  constexpr int per_thread = 2'000;
+  std::atomic<int> acquired{0};
+  std::vector<std::thread> threads;
+  for ( int threadId = 0; threadId < 4; ++threadId ) {
+    threads.push_back(std::thread{[&]{
+      for ( int i = 0; i < per_thread; ++i ) {
+        [](auto& pool, std::atomic<int>& acquired) -> Detached {
+          char* acq = co_await pool.async_acquire(8);
+          ++acquired;
+          pool.release(acq);
+        }(pool, acquired);
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  EXPECT_EQ(acquired, 4 * per_thread);
+}
+
+template <typename Pool>
+bool swarm(xul::StripAffinity affinity)
+{
+  Pool pool{affinity};
+  std::atomic<bool> overlap{false};
 
   std::vector<std::thread> threads;
   for ( unsigned threadId = 0; threadId < 24; ++threadId ) {
     threads.push_back(std::thread{[threadId, &overlap, &pool]{
-      overlap = overlap || fillbo_faggins(pool, threadId);
+      if ( fillbo_faggins(pool, threadId) ) {
+        overlap = true;
+      }
     }});
   }
 
   for ( auto& thread: threads ) {
     thread.join();
   }
+  return overlap;
+}
+
+// Not recommended to run this on debug. It takes forever.
+TYPED_TEST(Stripool, DISABLED_Swarm)
+{
+  using Pool = typename TestFixture::template ArrayStripool<32, 12>;
+  EXPECT_FALSE(swarm<Pool>(xul::StripAffinity::shared));
+}
+
+TYPED_TEST(Stripool, DISABLED_SwarmThreadAffinity)
+{
+  using Pool = typename TestFixture::template ArrayStripool<32, 12>;
+  EXPECT_FALSE(swarm<Pool>(xul::StripAffinity::thread));
+}
+
+TYPED_TEST(Stripool, SwarmThreadAffinityBriefly)
+{
+  // More threads than strips, so that threads share strips, and spill over
+  // into each other's when their own is taken.
+  typename TestFixture::template ArrayStripool<32, 4> pool{xul::StripAffinity::thread};
+  std::atomic<bool> overlap{false};
+  std::vector<std::thread> threads;
+  for ( char threadId = 0; threadId < 8; ++threadId ) {
+    threads.push_back(std::thread{[threadId, &overlap, &pool]{
+      for ( int i = 0; i < 5'000; ++i ) {
+        char* acq = pool.acquire(8);
+        while ( !acq ) {
+          std::this_thread::yield();
+          acq = pool.acquire(8);
+        }
+        std::fill_n(acq, 8, threadId);
+        std::this_thread::yield();
+        if ( std::count(acq, acq + 8, threadId) != 8 ) {
+          overlap = true;
+        }
+        pool.release(acq);
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  EXPECT_FALSE(overlap);
+
+  // Every acquisition was released, so every strip is whole again.
+  for ( int i = 0; i < 4; ++i ) {
+    EXPECT_NE(pool.acquire(32), nullptr);
+  }
+  EXPECT_EQ(pool.acquire(1), nullptr);
+}
+
+TEST(StripBookkeeping, CountLimitsAcquisitions)
+{
+  // Only 3 acquisitions can be counted, so the 4th in a strip has to spill
+  // into the next strip, even though it would fit.
+  using Bookkeeping = xul::StripBookkeeping<std::uint32_t, 2>;
+  static_assert(Bookkeeping::max_count == 3);
+  xul::ArrayStripool<256, 2, xul::StripLayout::interleaved, Bookkeeping> pool;
+  std::vector<char*> acqs;
+  for ( int i = 0; i < 6; ++i ) {
+    acqs.push_back(pool.acquire(1));
+    ASSERT_NE(acqs.back(), nullptr);
+  }
+  EXPECT_GE(acqs[3], acqs[2] + 128);
+  EXPECT_EQ(pool.acquire(1), nullptr);
+  for ( auto acq : acqs ) {
+    pool.release(acq);
+  }
+  // The second strip was the last acquired from, so is where we start again.
+  EXPECT_EQ(pool.acquire(1), acqs[3]);
+}
+
+TEST(StripBookkeeping, ManySmallAcquisitions)
+{
+  // A 16-bit count allows a single strip to hold 65535 small acquisitions,
+  // which is more than the default allows for, even with space to spare.
+  using Bookkeeping = xul::StripBookkeeping<std::uint64_t, 16>;
+  static_assert(Bookkeeping::max_count == 65535);
+  static xul::ArrayStripool<65536 * 32, 1, xul::StripLayout::interleaved, Bookkeeping> pool;
+  std::vector<char*> acqs;
+  for ( std::size_t i = 0; i < Bookkeeping::max_count; ++i ) {
+    acqs.push_back(pool.acquire(1));
+    ASSERT_NE(acqs.back(), nullptr) << "Acquisition " << i;
+  }
+  EXPECT_EQ(pool.acquire(1), nullptr);
+  for ( auto acq : acqs ) {
+    pool.release(acq);
+  }
+  EXPECT_EQ(pool.acquire(1), acqs[0]);
+}
+
+TEST(StripParking, Backpressure)
+{
+  // Many more threads than strips, all parking rather than spinning, must
+  // never miss the wake up from a release.
+  xul::ArrayStripool<8, 2> pool;
+  std::vector<std::thread> threads;
+  for ( int threadId = 0; threadId < 8; ++threadId ) {
+    threads.push_back(std::thread{[&pool]{
+      for ( int i = 0; i < 20'000; ++i ) {
+        char* acq = pool.acquire_wait(8);
+        std::fill_n(acq, 8, 'x');
+        pool.release(acq);
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+}
+
+TYPED_TEST(Stripool, AcquireBulk)
+{
+  typename TestFixture::template ArrayStripool<128, 3> pool;
+  // The whole batch is claimed from the first strip, one after another.
+  const std::uint32_t sizes[] = {8, 16, 24};
+  char* acqs[3];
+  ASSERT_TRUE(pool.acquire_bulk(sizes, acqs));
+  EXPECT_EQ(acqs[1], acqs[0] + 16 + 16);
+  EXPECT_EQ(acqs[2], acqs[1] + 16 + 16);
+  std::fill_n(acqs[0], 8, 'a');
+  std::fill_n(acqs[1], 16, 'b');
+  std::fill_n(acqs[2], 24, 'c');
+
+  // Too large a batch for one strip is acquired one at a time.
+  const std::uint32_t larger[] = {96, 96};
+  char* more[2];
+  ASSERT_TRUE(pool.acquire_bulk(larger, more));
+
+  // If any acquisition can't be made, none are.
+  char* none[2] = {};
+  EXPECT_FALSE(pool.acquire_bulk(larger, none));
+  EXPECT_EQ(pool.acquire(96), nullptr);
+
+  // Every acquisition is released, with the strips reset.
+  pool.release_bulk(more);
+  pool.release_bulk(acqs);
+  ASSERT_TRUE(pool.acquire_bulk(sizes, acqs));
+  EXPECT_NE(pool.acquire(96), nullptr);
+}
+
+TEST(StripBookkeeping, BulkCountLimit)
+{
+  // A batch that can't be counted by one strip is spread over strips.
+  using Bookkeeping = xul::StripBookkeeping<std::uint32_t, 2>;
+  xul::ArrayStripool<256, 2, xul::StripLayout::interleaved, Bookkeeping> pool;
+  const std::uint32_t sizes[] = {1, 1, 1, 1};
+  char* acqs[4];
+  ASSERT_TRUE(pool.acquire_bulk(sizes, acqs));
+  EXPECT_GE(acqs[3], acqs[2] + 128);
+
+  // Releasing acquisitions from the strips in any order resets them both.
+  char* interleaved[] = {acqs[3], acqs[0], acqs[1], acqs[2]};
+  pool.release_bulk(interleaved);
+  std::vector<char*> all;
+  while ( char* acq = pool.acquire(100) ) {
+    all.push_back(acq);
+  }
+  EXPECT_EQ(all.size(), 4);
+}
+
+TYPED_TEST(Stripool, AcquireAligned)
+{
+  const auto acquireAligned = [](auto& pool) {
+    for ( std::size_t alignment = 1; alignment <= xul::Stripool::max_alignment; alignment *= 2 ) {
+      // Two acquisitions, to have the second land after the first, rather than
+      // at the start of the strip.
+      char* acqs[2];
+      for ( auto& acq : acqs ) {
+        acq = pool.acquire(24, alignment);
+        ASSERT_NE(acq, nullptr) << "Alignment " << alignment;
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(acq) % alignment, 0) << "Alignment " << alignment;
+        std::fill_n(acq, 24, 'a');
+      }
+      // Padding is only what it takes to align the second acquisition, after
+      // the 24 bytes of the first, padded out to 32, and a pointer back to the
+      // strip.
+      EXPECT_LT(acqs[1] - acqs[0], 48 + std::max<std::size_t>(alignment, 16)) << "Alignment " << alignment;
+      pool.release(acqs[0]);
+      pool.release(acqs[1]);
+    }
+  };
+  // Strips have room for both acquisitions at the largest alignment, however
+  // the pool's memory lands.
+  acquireAligned(*std::make_unique<typename TestFixture::template ArrayStripool<16384, 2>>());
+  acquireAligned(*std::make_unique<typename TestFixture::template ArrayStripool<16384, 2, xul::StripLayout::isolated>>());
+}
+
+TYPED_TEST(Stripool, ExtendAndShrink)
+{
+  const auto extendAndShrink = [](auto& pool) {
+    char* a = pool.acquire(16);
+    ASSERT_NE(a, nullptr);
+    ASSERT_TRUE(pool.try_extend(a, 16, 64));
+    std::fill_n(a, 64, 'a');
+    char* b = pool.acquire(16);
+    ASSERT_EQ(b, a + 64 + 16);
+
+    // Only the last acquisition can grow, and only as far as the strip has room.
+    EXPECT_FALSE(pool.try_extend(a, 64, 80));
+    EXPECT_FALSE(pool.try_extend(b, 16, 64));
+    ASSERT_TRUE(pool.try_extend(b, 16, 48));
+    std::fill_n(b, 48, 'b');
+
+    // Shrinking the last acquisition gives its space back straight away.
+    pool.shrink(b, 48, 0);
+    char* c = pool.acquire(16);
+    EXPECT_EQ(c, b + 16);
+
+    // Shrinking any other acquisition leaves the space where it is.
+    EXPECT_TRUE(pool.try_extend(a, 64, 16));
+    EXPECT_EQ(pool.acquire(16), nullptr);
+    EXPECT_EQ(std::count(a, a + 64, 'a'), 64);
+
+    pool.release(a);
+    pool.release(b);
+    pool.release(c);
+    EXPECT_NE(pool.acquire(128), nullptr);
+  };
+  {
+    typename TestFixture::template ArrayStripool<128, 1> pool;
+    extendAndShrink(pool);
+  }
+  {
+    typename TestFixture::template ArrayStripool<128, 1, xul::StripLayout::isolated> pool;
+    extendAndShrink(pool);
+  }
+}
+
+TYPED_TEST(Stripool, RollsBackLastAcquisition)
+{
+  const auto rollsBack = [](auto& pool) {
+    // A long lived acquisition doesn't keep the strip from being reused by
+    // acquisitions released in stack order.
+    char* pinned = pool.acquire(16);
+    ASSERT_NE(pinned, nullptr);
+    for ( int i = 0; i < 1000; ++i ) {
+      char* outer = pool.acquire(16);
+      ASSERT_EQ(outer, pinned + 32);
+      char* inner = pool.acquire(16);
+      ASSERT_EQ(inner, outer + 32);
+      pool.release(inner);
+      pool.release(outer);
+    }
+
+    // Alignment padding is given back along with the acquisition.
+    char* aligned = pool.acquire(16, 256);
+    ASSERT_NE(aligned, nullptr);
+    pool.release(aligned);
+    EXPECT_EQ(pool.acquire(16), pinned + 32);
+
+    // Releasing out of stack order leaves the space until the strip is reset.
+    char* last = pool.acquire(16);
+    pool.release(pinned + 32);
+    EXPECT_EQ(pool.acquire(16), last + 32);
+  };
+  {
+    typename TestFixture::template ArrayStripool<512, 1> pool;
+    rollsBack(pool);
+  }
+  {
+    typename TestFixture::template ArrayStripool<512, 1, xul::StripLayout::isolated> pool;
+    rollsBack(pool);
+  }
+}
+
+TEST(StripBookkeeping, InvalidAlignment)
+{
+  xul::ArrayStripool<8192, 2> pool;
+  EXPECT_EQ(pool.acquire(8, 0), nullptr);
+  EXPECT_EQ(pool.acquire(8, 3), nullptr);
+  EXPECT_EQ(pool.acquire(8, 48), nullptr);
+  EXPECT_EQ(pool.acquire(8, xul::Stripool::max_alignment * 2), nullptr);
+  EXPECT_NE(pool.acquire(8, xul::Stripool::max_alignment), nullptr);
+}
+
+TEST(StripStats, CountsAcquisitions)
+{
+  using Pool = xul::ArrayStripool<16, 2, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<>>;
+  // Recording stats takes no room in the strips, as releases find the stats
+  // through the pool their strip points back to.
+  static_assert(Pool::raw_strip_size() == xul::ArrayStripool<16, 2>::raw_strip_size());
+  Pool pool;
+  auto acq1 = pool.acquire(16);
+  auto acq2 = pool.acquire(16);
+  ASSERT_NE(acq1, nullptr);
+  ASSERT_NE(acq2, nullptr);
+  EXPECT_EQ(pool.acquire(16), nullptr);
+  pool.release(acq1);
+  pool.release(acq2);
+
+  const auto stats = pool.stats();
+  EXPECT_EQ(stats.acquires, 2);
+  EXPECT_EQ(stats.failedAcquires, 1);
+  // The first acquisition found room straight away, and the second after
+  // finding the first strip full, with the third finding both strips full.
+  EXPECT_EQ(stats.stripsScanned, 1 + 2 + 2);
+  EXPECT_EQ(stats.casAttempts, 4);
+  EXPECT_EQ(stats.casRetries, 0);
+  EXPECT_EQ(stats.stripResets, 2);
+  EXPECT_EQ(stats.headRollbacks, 0);
+  EXPECT_EQ(stats.peakStripCount, 1);
+}
+
+TEST(StripStats, CountsHeadRollbacks)
+{
+  using Pool = xul::ArrayStripool<64, 1, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<>>;
+  Pool pool;
+  auto acq1 = pool.acquire(16);
+  auto acq2 = pool.acquire(16);
+  pool.release(acq2);
+  pool.release(acq1);
+
+  const auto stats = pool.stats();
+  EXPECT_EQ(stats.headRollbacks, 1);
+  EXPECT_EQ(stats.stripResets, 1);
+}
+
+TEST(StripStats, ShardedAcrossThreads)
+{
+  using Pool = xul::ArrayStripool<8, 4, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<4>>;
+  Pool pool;
+  std::vector<std::thread> threads;
+  for ( int threadId = 0; threadId < 8; ++threadId ) {
+    threads.push_back(std::thread{[&pool]{
+      for ( int i = 0; i < 10'000; ++i ) {
+        pool.release(pool.acquire_wait(8));
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  const auto stats = pool.stats();
+  EXPECT_EQ(stats.acquires, 80'000);
+  EXPECT_EQ(stats.stripResets, 80'000);
+  // Every acquisition and release ends with one successful compare-exchange.
+  EXPECT_EQ(stats.casAttempts - stats.casRetries, 160'000);
+  EXPECT_EQ(stats.peakStripCount, 1);
+}
+
+TEST(StripOccupancy, SkipsFullStrips)
+{
+  using Pool = xul::ArrayStripool<64, 200, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<>, xul::StripOccupancy>;
+  auto pool = std::make_unique<Pool>();
+  std::vector<char*> acqs;
+  for ( int i = 0; i < 200; ++i ) {
+    acqs.push_back(pool->acquire(64));
+    ASSERT_NE(acqs.back(), nullptr);
+  }
+  EXPECT_EQ(pool->acquire(64), nullptr);
+
+  // Strips that give back space are skipped straight to, rather than
+  // looking at every full strip on the way.
+  pool->release(acqs[100]);
+  pool->release(acqs[150]);
+  const auto before = pool->stats();
+  acqs[100] = pool->acquire(64);
+  EXPECT_EQ(pool->strip_index(acqs[100]), 100u);
+  acqs[150] = pool->acquire(64);
+  EXPECT_EQ(pool->strip_index(acqs[150]), 150u);
+  const auto after = pool->stats();
+  EXPECT_EQ(after.stripsScanned - before.stripsScanned, 3u);
+
+  for ( char* acq : acqs ) {
+    pool->release(acq);
+  }
+  EXPECT_NE(pool->acquire(64), nullptr);
+}
+
+TEST(StripOccupancy, LooksAtEveryStripWhenNoneThoughtToHaveRoom)
+{
+  using Pool = xul::ArrayStripool<64, 2, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::NoStripStats, xul::StripOccupancy>;
+  Pool pool;
+  // The first strip is left with room for only a small acquisition.
+  auto acq1 = pool.acquire(48);
+  auto acq2 = pool.acquire(64);
+  ASSERT_NE(acq1, nullptr);
+  ASSERT_NE(acq2, nullptr);
+  EXPECT_EQ(pool.strip_index(acq2), 1u);
+  EXPECT_EQ(pool.acquire(64), nullptr);
+
+  auto acq3 = pool.acquire(0);
+  ASSERT_NE(acq3, nullptr);
+  EXPECT_EQ(pool.strip_index(acq3), 0u);
+
+  // Shrinking gives space back, which is skipped to.
+  pool.shrink(acq2, 64, 16);
+  auto acq4 = pool.acquire(16);
+  ASSERT_NE(acq4, nullptr);
+  EXPECT_EQ(pool.strip_index(acq4), 1u);
 }
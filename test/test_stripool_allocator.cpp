@@ -0,0 +1,118 @@
+#include <xul/stripool_allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+/// Upstream allocator that counts what is outstanding.
+template <typename T>
+struct CountingAllocator
+{
+  using value_type = T;
+
+  explicit CountingAllocator(int& outstanding_) noexcept : outstanding{&outstanding_} {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other) noexcept : outstanding{other.outstanding} {}
+
+  T* allocate(std::size_t n) {
+    ++*outstanding;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    --*outstanding;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const CountingAllocator&, const CountingAllocator&) = default;
+
+  int* outstanding;
+};
+
+xul::ArrayStripool<4096, 16> staticPool;
+
+}
+
+TEST(StripoolAllocator, Containers)
+{
+  static_assert(sizeof(xul::StripoolAllocator<int>) == sizeof(void*));
+  auto pool = std::make_unique<xul::ArrayStripool<4096, 16>>();
+
+  std::vector<int, xul::StripoolAllocator<int>> ints{xul::StripoolAllocator<int>{*pool}};
+  for ( int i = 0; i < 100; ++i ) {
+    ints.push_back(i);
+  }
+  EXPECT_TRUE(pool->owns(ints.data()));
+  EXPECT_EQ(ints[99], 99);
+
+  using String = std::basic_string<char, std::char_traits<char>, xul::StripoolAllocator<char>>;
+  String string{"a string too long for the small string optimisation", xul::StripoolAllocator<char>{*pool}};
+  EXPECT_TRUE(pool->owns(string.data()));
+
+  std::list<int, xul::StripoolAllocator<int>> list{xul::StripoolAllocator<int>{*pool}};
+  std::map<int, int, std::less<>, xul::StripoolAllocator<std::pair<const int, int>>> map{
+    xul::StripoolAllocator<std::pair<const int, int>>{*pool}};
+  for ( int i = 0; i < 100; ++i ) {
+    list.push_back(i);
+    map.emplace(i, i);
+  }
+  EXPECT_TRUE(pool->owns(&list.back()));
+  EXPECT_TRUE(pool->owns(&map.at(99)));
+  EXPECT_EQ(list.size(), 100);
+  EXPECT_EQ(map.size(), 100);
+}
+
+TEST(StripoolAllocator, FallsBackUpstream)
+{
+  xul::ArrayStripool<64, 2> pool;
+  int outstanding = 0;
+  using Allocator = xul::StripoolAllocator<int, xul::Stripool, CountingAllocator<int>>;
+  Allocator allocator{pool, CountingAllocator<int>{outstanding}};
+  {
+    std::list<int, Allocator> list{allocator};
+    for ( int i = 0; i < 8; ++i ) {
+      list.push_back(i);
+    }
+    // Only some of the nodes fit in the pool, with the rest allocated upstream.
+    EXPECT_GT(outstanding, 0);
+    EXPECT_LT(outstanding, 8);
+  }
+  // Each node went back to wherever it came from.
+  EXPECT_EQ(outstanding, 0);
+  EXPECT_NE(pool.acquire(64), nullptr);
+}
+
+TEST(StripoolAllocator, Equality)
+{
+  xul::ArrayStripool<64, 1> pool1;
+  xul::ArrayStripool<64, 1> pool2;
+  const xul::StripoolAllocator<int> allocator1{pool1};
+  const xul::StripoolAllocator<long> rebound{allocator1};
+  EXPECT_TRUE(allocator1 == rebound);
+  EXPECT_FALSE(allocator1 == xul::StripoolAllocator<int>{pool2});
+}
+
+TEST(StaticStripoolAllocator, Stateless)
+{
+  using Allocator = xul::StaticStripoolAllocator<int, staticPool>;
+  static_assert(std::is_empty_v<Allocator>);
+  static_assert(std::allocator_traits<Allocator>::is_always_equal::value);
+
+  std::vector<int, Allocator> ints;
+  std::map<int, int, std::less<>, xul::StaticStripoolAllocator<std::pair<const int, int>, staticPool>> map;
+  for ( int i = 0; i < 100; ++i ) {
+    ints.push_back(i);
+    map.emplace(i, i);
+  }
+  EXPECT_TRUE(staticPool.owns(ints.data()));
+  EXPECT_TRUE(staticPool.owns(&map.at(99)));
+  EXPECT_TRUE((Allocator{} == xul::StaticStripoolAllocator<long, staticPool>{}));
+}
@@ -0,0 +1,144 @@
+#include <xul/stripool_chained.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Each segment holds 4 acquisitions of up to 64 bytes.
+const xul::ChainedStripoolConfig config{
+  .segment = {.stripSize = 64, .stripCount = 4},
+  .maxSegments = 3};
+
+std::vector<char*> acquireN(xul::ChainedStripool& pool, std::size_t n)
+{
+  std::vector<char*> acqs;
+  for ( std::size_t i = 0; i < n; ++i ) {
+    acqs.push_back(pool.acquire(64));
+  }
+  return acqs;
+}
+
+void releaseAll(const std::vector<char*>& acqs)
+{
+  for ( auto acq : acqs ) {
+    xul::ChainedStripool::release(acq);
+  }
+}
+
+}
+
+TEST(ChainedStripool, GrowsUpToCeiling)
+{
+  xul::ChainedStripool pool{config};
+  auto acqs = acquireN(pool, 4);
+  EXPECT_EQ(pool.segments(), 0);
+
+  auto more = acquireN(pool, 12);
+  EXPECT_EQ(pool.segments(), 3);
+  for ( auto acq : more ) {
+    ASSERT_NE(acq, nullptr);
+    std::memset(acq, 'x', 64);
+  }
+  EXPECT_EQ(pool.acquire(64), nullptr);
+  EXPECT_EQ(pool.segments(), 3);
+
+  // Releases don't need to know which segment they came from.
+  releaseAll(more);
+  releaseAll(acqs);
+  EXPECT_EQ(acquireN(pool, 16).size(), 16);
+}
+
+TEST(ChainedStripool, DoesNotGrowForOversizedAcquisitions)
+{
+  xul::ChainedStripool pool{config};
+  for ( int i = 0; i < 3; ++i ) {
+    EXPECT_EQ(pool.acquire(4096), nullptr);
+  }
+  EXPECT_EQ(pool.segments(), 0);
+}
+
+TEST(ChainedStripool, TrimsIdleSegments)
+{
+  xul::ChainedStripool pool{config};
+  auto acqs = acquireN(pool, 12);
+  EXPECT_EQ(pool.segments(), 2);
+
+  // Segments that are holding acquisitions are never given back.
+  EXPECT_EQ(pool.trim(0), 0);
+
+  // Release everything from the last segment, which is then idle.
+  releaseAll({acqs.begin() + 8, acqs.end()});
+  acqs.resize(8);
+  // It has gone unused for the one trim above, but not for two.
+  EXPECT_EQ(pool.trim(2), 0);
+  EXPECT_EQ(pool.trim(2), 1);
+  EXPECT_EQ(pool.segments(), 1);
+
+  // The pool grows again as needed.
+  auto more = acquireN(pool, 4);
+  for ( auto acq : more ) {
+    EXPECT_NE(acq, nullptr);
+  }
+  EXPECT_EQ(pool.segments(), 2);
+  releaseAll(more);
+  releaseAll(acqs);
+
+  // Everything is idle, but the primary segment stays.
+  EXPECT_EQ(pool.trim(5), 0);
+  EXPECT_EQ(pool.trim(0), 2);
+  EXPECT_EQ(pool.segments(), 0);
+}
+
+TEST(ChainedStripool, ConcurrentGrowAndTrim)
+{
+  xul::ChainedStripool pool{{
+    .segment = {.stripSize = 32, .stripCount = 8},
+    .maxSegments = 8}};
+  std::atomic<bool> done{false};
+  std::atomic<bool> overlap{false};
+
+  std::thread trimmer{[&]{
+    while ( !done ) {
+      pool.trim(0);
+    }
+  }};
+
+  std::vector<std::thread> threads;
+  for ( int threadId = 0; threadId < 8; ++threadId ) {
+    threads.push_back(std::thread{[&, threadId]{
+      std::vector<char*> acqs;
+      for ( int round = 0; round < 200; ++round ) {
+        // Bursts of acquisitions, that need chained segments, then released.
+        for ( int i = 0; i < 8; ++i ) {
+          if ( char* acq = pool.acquire(32) ) {
+            std::memset(acq, threadId, 32);
+            acqs.push_back(acq);
+          }
+        }
+        for ( auto acq : acqs ) {
+          for ( int i = 0; i < 32; ++i ) {
+            if ( acq[i] != threadId ) {
+              overlap = true;
+            }
+          }
+          xul::ChainedStripool::release(acq);
+        }
+        acqs.clear();
+      }
+    }});
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  done = true;
+  trimmer.join();
+  EXPECT_FALSE(overlap);
+
+  pool.trim(0);
+  EXPECT_EQ(pool.segments(), 0);
+}
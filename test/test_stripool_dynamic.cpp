@@ -0,0 +1,95 @@
+#include <xul/stripool_dynamic.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/// Fill every strip of the *pool* with a single *size* acquisition, check
+/// no more fit, then release them all.
+void fillStrips(xul::DynamicStripool& pool, std::size_t stripCount, std::uint32_t size)
+{
+  std::vector<char*> acqs;
+  for ( std::size_t i = 0; i < stripCount; ++i ) {
+    acqs.push_back(pool.acquire(size));
+    ASSERT_NE(acqs.back(), nullptr);
+    std::fill_n(acqs.back(), size, static_cast<char>(i));
+  }
+  EXPECT_EQ(pool.acquire(size), nullptr);
+  for ( std::size_t i = 0; i < stripCount; ++i ) {
+    EXPECT_EQ(acqs[i][0], static_cast<char>(i));
+    EXPECT_EQ(acqs[i][size - 1], static_cast<char>(i));
+    pool.release(acqs[i]);
+  }
+}
+
+}
+
+TEST(DynamicStripool, SizedAtRuntime)
+{
+  xul::DynamicStripool pool{{.stripSize = 1000, .stripCount = 64}};
+  EXPECT_EQ(pool.pages(), xul::StripPages::standard);
+  fillStrips(pool, 64, 1000);
+  fillStrips(pool, 64, 1000);
+}
+
+TEST(DynamicStripool, MatchesArrayStripool)
+{
+  // Same strips as the equivalent array pool, so the first acquisition is in
+  // the same place.
+  xul::ArrayStripool<16, 3> array;
+  xul::DynamicStripool pool{{.stripSize = 16, .stripCount = 3}};
+  EXPECT_EQ(
+    pool.acquire(16) - static_cast<const char*>(pool.memory()),
+    array.acquire(16) - static_cast<const char*>(array.memory()));
+}
+
+TEST(DynamicStripool, IsolatedHeaders)
+{
+  xul::DynamicStripool pool{{
+    .stripSize = 100,
+    .stripCount = 16,
+    .layout = xul::StripLayout::isolated,
+    .affinity = xul::StripAffinity::thread}};
+  EXPECT_EQ(pool.acquire(100), static_cast<const char*>(pool.memory()) + alignof(std::max_align_t));
+  fillStrips(pool, 15, 100);
+}
+
+TEST(DynamicStripool, TransparentHugePages)
+{
+  xul::DynamicStripool pool{{
+    .stripSize = 4096,
+    .stripCount = 1024,
+    .pages = xul::StripPages::transparent_huge,
+    .prefault = true}};
+  EXPECT_EQ(pool.pages(), xul::StripPages::transparent_huge);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pool.memory()) % xul::StripMapping::huge_page_size, 0);
+  EXPECT_EQ(pool.mapped_size() % xul::StripMapping::huge_page_size, 0);
+  fillStrips(pool, 1024, 4096);
+}
+
+TEST(DynamicStripool, HugePages)
+{
+  // Most systems don't have huge pages reserved, so this will usually fall
+  // back to transparent huge pages.
+  xul::DynamicStripool pool{{
+    .stripSize = 4096,
+    .stripCount = 16,
+    .pages = xul::StripPages::huge,
+    .prefault = true}};
+  EXPECT_NE(pool.pages(), xul::StripPages::standard);
+  EXPECT_EQ(pool.mapped_size() % xul::StripMapping::huge_page_size, 0);
+  fillStrips(pool, 16, 4096);
+}
+
+TEST(DynamicStripool, InvalidConfig)
+{
+  EXPECT_THROW(xul::DynamicStripool({.stripSize = 16, .stripCount = 0}), std::invalid_argument);
+  EXPECT_THROW(xul::DynamicStripool({.stripSize = 1 << 24, .stripCount = 1}), std::invalid_argument);
+  using Bookkeeping = xul::StripBookkeeping<std::uint64_t, 16>;
+  EXPECT_NO_THROW(xul::BasicDynamicStripool<Bookkeeping>({.stripSize = 1 << 24, .stripCount = 1}));
+}
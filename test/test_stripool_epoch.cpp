@@ -0,0 +1,73 @@
+#include <xul/stripool_epoch.hpp>
+#include <xul/stripool_dynamic.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(StripEpochs, DefersReleaseWhileReading)
+{
+  xul::ArrayStripool<64, 1> pool;
+  xul::StripEpochs epochs;
+  xul::StripEpochs<>::Participant reader{epochs};
+  xul::StripEpochs<>::Participant writer{epochs};
+
+  char* acq = pool.acquire(64);
+  ASSERT_NE(acq, nullptr);
+  {
+    auto guard = reader.guard();
+    writer.retire(acq);
+    for ( int i = 0; i < 3; ++i ) {
+      writer.collect();
+    }
+    EXPECT_EQ(writer.pending(), 1u);
+    EXPECT_EQ(pool.acquire(1), nullptr);
+  }
+  writer.collect();
+  EXPECT_EQ(writer.pending(), 0u);
+  EXPECT_NE(pool.acquire(64), nullptr);
+}
+
+TEST(StripEpochs, BatchesRetirements)
+{
+  xul::DynamicStripool pool{{.stripSize = 64, .stripCount = 1024}};
+  xul::StripEpochs epochs;
+  xul::StripEpochs<>::Participant writer{epochs};
+  constexpr std::size_t batch_size = xul::StripEpochs<>::batch_size;
+
+  const auto startEpoch = epochs.epoch();
+  for ( std::size_t i = 0; i < batch_size - 1; ++i ) {
+    writer.retire(pool.acquire(64));
+  }
+  EXPECT_EQ(writer.pending(), batch_size - 1);
+  EXPECT_EQ(epochs.epoch(), startEpoch);
+
+  // A full batch advances the epoch, but its acquisitions are only released
+  // once it has advanced again.
+  writer.retire(pool.acquire(64));
+  EXPECT_EQ(epochs.epoch(), startEpoch + 1);
+  EXPECT_EQ(writer.pending(), batch_size);
+  for ( std::size_t i = 0; i < batch_size; ++i ) {
+    writer.retire(pool.acquire(64));
+  }
+  EXPECT_EQ(writer.pending(), batch_size);
+}
+
+TEST(StripEpochs, HandsOverRetirementsOnExit)
+{
+  xul::ArrayStripool<64, 2> pool;
+  xul::StripEpochs epochs;
+  xul::StripEpochs<>::Participant reader{epochs};
+  {
+    xul::StripEpochs<>::Participant writer{epochs};
+    writer.retire(pool.acquire(64));
+    writer.retire(pool.acquire(64));
+  }
+  EXPECT_EQ(pool.acquire(1), nullptr);
+
+  // Released by whoever next advances the epoch far enough.
+  reader.collect();
+  reader.collect();
+  EXPECT_NE(pool.acquire(64), nullptr);
+  EXPECT_NE(pool.acquire(64), nullptr);
+}
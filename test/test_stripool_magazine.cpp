@@ -0,0 +1,111 @@
+#include <xul/stripool_magazine.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(StripMagazine, AcquiresWithoutExchanges)
+{
+  using Pool = xul::ArrayStripool<1024, 2, xul::StripLayout::interleaved, xul::Stripool::bookkeeping, xul::StripStats<>>;
+  Pool pool;
+  {
+    xul::StripMagazine magazine{pool, 256, 8};
+    char* acq1 = magazine.acquire(16);
+    char* acq2 = magazine.acquire(16);
+    char* acq3 = magazine.acquire(8);
+    ASSERT_NE(acq1, nullptr);
+    EXPECT_EQ(acq2, acq1 + 32);
+    EXPECT_EQ(acq3, acq2 + 32);
+    // Only reserving the chunk touched the strip.
+    EXPECT_EQ(pool.stats().casAttempts, 1);
+    magazine.release(acq1);
+    magazine.release(acq2);
+    magazine.release(acq3);
+  }
+  // The strip was reset once the magazine gave back the rest of the chunk.
+  EXPECT_EQ(pool.stats().stripResets, 1);
+  EXPECT_NE(pool.acquire(1024), nullptr);
+  EXPECT_NE(pool.acquire(1024), nullptr);
+}
+
+TEST(StripMagazine, ReloadsWhenDrained)
+{
+  xul::ArrayStripool<1024, 1> pool;
+  xul::StripMagazine magazine{pool, 64, 8};
+  char* acq1 = magazine.acquire(16);
+  char* acq2 = magazine.acquire(16);
+  char* acq3 = magazine.acquire(16);
+  EXPECT_EQ(acq2, acq1 + 32);
+  // Out of space, so the next chunk follows straight on.
+  EXPECT_EQ(acq3, acq2 + 32);
+
+  // Out of acquisitions, so the rest of the chunk is given back.
+  xul::StripMagazine counted{pool, 256, 1};
+  char* acq4 = counted.acquire(16);
+  char* acq5 = counted.acquire(16);
+  EXPECT_EQ(acq5, acq4 + 32);
+
+  for ( char* acq : {acq1, acq2, acq3, acq4, acq5} ) {
+    xul::Stripool::release(acq);
+  }
+}
+
+TEST(StripMagazine, GivesBackUnusedSpace)
+{
+  xul::ArrayStripool<256, 1> pool;
+  xul::StripMagazine magazine{pool, 128};
+  char* acq1 = magazine.acquire(16);
+  magazine.drain();
+  char* acq2 = pool.acquire(16);
+  EXPECT_EQ(acq2, acq1 + 32);
+  pool.release(acq2);
+  magazine.release(acq1);
+  EXPECT_NE(pool.acquire(256), nullptr);
+}
+
+TEST(StripMagazine, KeepsStripUntilDrained)
+{
+  // Every acquisition from the chunk is released, but the strip mustn't reset
+  // under the chunk, lest what is acquired after it be given back on draining.
+  xul::ArrayStripool<1024, 1> pool;
+  xul::StripMagazine magazine{pool, 512, 2};
+  magazine.release(magazine.acquire(16));
+  magazine.release(magazine.acquire(16));
+  char* large = pool.acquire(496);
+  ASSERT_NE(large, nullptr);
+  magazine.drain();
+  char* small = pool.acquire(16);
+  EXPECT_TRUE(!small || small + 16 <= large || small >= large + 496);
+}
+
+TEST(StripMagazine, FallsBackToPool)
+{
+  xul::ArrayStripool<256, 1> pool;
+  xul::StripMagazine magazine{pool, 64};
+  char* small = magazine.acquire(16);
+  char* large = magazine.acquire(100);
+  ASSERT_NE(large, nullptr);
+  // Too large for a chunk, so acquired after the one chunk, which is kept.
+  EXPECT_EQ(large, small + 64);
+  EXPECT_EQ(magazine.acquire(16), small + 32);
+}
+
+TEST(StripMagazine, ReleasesFromOtherThreads)
+{
+  xul::ArrayStripool<512, 1> pool;
+  std::vector<char*> acqs;
+  {
+    xul::StripMagazine magazine{pool, 512 - 32};
+    for ( int i = 0; i < 8; ++i ) {
+      acqs.push_back(magazine.acquire(16));
+    }
+    std::thread{[&]{
+      for ( char* acq : acqs ) {
+        xul::Stripool::release(acq);
+      }
+    }}.join();
+    EXPECT_EQ(pool.acquire(512), nullptr);
+  }
+  EXPECT_NE(pool.acquire(512), nullptr);
+}
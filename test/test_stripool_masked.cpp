@@ -0,0 +1,69 @@
+#include <xul/stripool_masked.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+TEST(MaskedStripool, PacksAcquisitions)
+{
+  // Acquisitions follow one another, with no pointer back to the strip
+  // between them, and only padded out to max alignment.
+  xul::ArrayMaskedStripool<256, 2> pool;
+  auto acq1 = pool.acquire(8);
+  ASSERT_NE(acq1, nullptr);
+  EXPECT_EQ(acq1, (char*)pool.memory() + alignof(std::max_align_t));
+  std::fill_n(acq1, 8, 'a');
+
+  auto acq2 = pool.acquire(16);
+  EXPECT_EQ(acq2, acq1 + alignof(std::max_align_t));
+  std::fill_n(acq2, 16, 'b');
+
+  auto acq3 = pool.acquire(1);
+  EXPECT_EQ(acq3, acq2 + 16);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(acq3) % alignof(std::max_align_t), 0);
+
+  pool.release(acq1);
+  pool.release(acq2);
+  pool.release(acq3);
+
+  // With everything released, the strip is reset.
+  EXPECT_EQ(pool.acquire(8), acq1);
+}
+
+TEST(MaskedStripool, FillsStrips)
+{
+  // Each strip has room for 15 max aligned acquisitions after its header.
+  constexpr auto per_strip = 256 / alignof(std::max_align_t) - 1;
+  xul::ArrayMaskedStripool<256, 3> pool;
+  for ( int goes = 0; goes < 10; ++goes ) {
+    std::vector<char*> acqs;
+    for ( std::size_t i = 0; i < per_strip * 3; ++i ) {
+      acqs.push_back(pool.acquire(alignof(std::max_align_t)));
+      ASSERT_NE(acqs.back(), nullptr);
+    }
+    EXPECT_EQ(pool.acquire(1), nullptr);
+
+    // Releases find their strip from the address alone, including the last
+    // acquisition of each strip, which ends at the start of the next strip.
+    for ( auto acq : acqs ) {
+      pool.release(acq);
+    }
+  }
+}
+
+TEST(MaskedStripool, ZeroSizedAcquisitions)
+{
+  xul::ArrayMaskedStripool<64, 2> pool;
+  std::vector<char*> acqs;
+  for ( int i = 0; i < 6; ++i ) {
+    acqs.push_back(pool.acquire(0));
+    ASSERT_NE(acqs.back(), nullptr);
+  }
+  EXPECT_EQ(pool.acquire(0), nullptr);
+  for ( auto acq : acqs ) {
+    pool.release(acq);
+  }
+  EXPECT_NE(pool.acquire(0), nullptr);
+}
@@ -0,0 +1,58 @@
+#include <xul/stripool_numa.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(NumaStripool, SystemTopology)
+{
+  const auto topology = xul::NumaTopology::system();
+  ASSERT_GE(topology.node_count(), 1);
+  EXPECT_LT(topology.current_node(), topology.node_count());
+
+  xul::NumaStripool pool{{.stripSize = 64, .stripsPerNode = 2}};
+  EXPECT_EQ(pool.node_count(), topology.node_count());
+  auto acq = pool.acquire(64);
+  ASSERT_NE(acq, nullptr);
+  EXPECT_TRUE(pool.partition(topology.current_node()).owns(acq));
+  pool.release(acq);
+}
+
+TEST(NumaStripool, FallsBackToOtherNodes)
+{
+  // Pretend every CPU is on the second of two nodes. Binding memory to nodes
+  // that don't exist fails, which leaves it unbound, so this works the same
+  // on a single node.
+  xul::NumaStripool pool{
+    {.stripSize = 64, .stripsPerNode = 2},
+    xul::NumaTopology{2, std::vector<std::size_t>(4096, 1)}};
+  std::vector<char*> acqs;
+  for ( int i = 0; i < 2; ++i ) {
+    acqs.push_back(pool.acquire(64));
+    ASSERT_NE(acqs.back(), nullptr);
+    EXPECT_TRUE(pool.partition(1).owns(acqs.back()));
+  }
+  for ( int i = 0; i < 2; ++i ) {
+    acqs.push_back(pool.acquire(64));
+    ASSERT_NE(acqs.back(), nullptr);
+    EXPECT_TRUE(pool.partition(0).owns(acqs.back()));
+  }
+  EXPECT_EQ(pool.acquire(64), nullptr);
+
+  // Releasing goes back to the partition acquired from.
+  pool.release(acqs[0]);
+  auto acq = pool.acquire(64);
+  EXPECT_TRUE(pool.partition(1).owns(acq));
+  pool.release(acq);
+  for ( std::size_t i = 1; i < acqs.size(); ++i ) {
+    pool.release(acqs[i]);
+  }
+}
+
+TEST(NumaStripool, UnknownCpusOnFirstNode)
+{
+  const xul::NumaTopology topology{2, {1, 1}};
+  EXPECT_EQ(topology.node_of_cpu(1), 1);
+  EXPECT_EQ(topology.node_of_cpu(2), 0);
+  EXPECT_EQ(xul::NumaTopology(0, {}).node_count(), 1);
+}
@@ -0,0 +1,110 @@
+#include <xul/stripool_object.hpp>
+#include <xul/stripool_masked.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+struct Counted
+{
+  explicit Counted(int& live, std::string name_ = {}) : live_{live}, name{std::move(name_)} { ++live_; }
+  ~Counted() { --live_; }
+
+  int& live_;
+  std::string name;
+};
+
+struct Throws
+{
+  Throws() { throw std::runtime_error{"Construction failed"}; }
+};
+
+}
+
+TEST(StripoolObjectPool, ConstructsAndDestroys)
+{
+  static_assert(sizeof(xul::pooled_ptr<Counted>) == sizeof(Counted*));
+  // Objects from any Stripool are released the same way, so have the same
+  // pointer type.
+  static_assert(std::is_same_v<
+    decltype(xul::make_pooled<Counted>(std::declval<xul::ArrayStripool<64, 1>&>(), std::declval<int&>())),
+    xul::pooled_ptr<Counted>>);
+  xul::ArrayStripool<64, 1> pool;
+  xul::StripoolObjectPool<Counted> objects{pool};
+  int live = 0;
+  {
+    auto counted = objects.make(live, "first");
+    ASSERT_TRUE(counted);
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(counted->name, "first");
+
+    // The pool is exhausted until the object goes out of scope.
+    EXPECT_EQ(objects.make(live), nullptr);
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+  EXPECT_TRUE(objects.make(live));
+  EXPECT_EQ(live, 0);
+}
+
+TEST(StripoolObjectPool, MovesOwnership)
+{
+  xul::ArrayStripool<64, 2> pool;
+  int live = 0;
+  auto first = xul::make_pooled<Counted>(pool, live);
+  auto second = xul::make_pooled<Counted>(pool, live);
+  EXPECT_EQ(live, 2);
+
+  Counted* object = first.get();
+  xul::pooled_ptr<Counted> moved{std::move(first)};
+  EXPECT_EQ(first, nullptr);
+  EXPECT_EQ(moved.get(), object);
+  EXPECT_EQ(live, 2);
+
+  // Assigning destroys and releases what was owned before.
+  second = std::move(moved);
+  EXPECT_EQ(live, 1);
+  EXPECT_EQ(second.get(), object);
+
+  second.reset();
+  EXPECT_EQ(live, 0);
+  EXPECT_TRUE(xul::make_pooled<Counted>(pool, live));
+}
+
+TEST(StripoolObjectPool, ReleasesWhenConstructorThrows)
+{
+  xul::ArrayStripool<64, 1> pool;
+  xul::StripoolObjectPool<Throws> objects{pool};
+  EXPECT_THROW((void)objects.make(), std::runtime_error);
+  EXPECT_NE(pool.acquire(64), nullptr);
+}
+
+TEST(StripoolObjectPool, HonoursAlignment)
+{
+  struct alignas(256) Aligned { char bytes[16]; };
+  auto pool = std::make_unique<xul::ArrayStripool<1024, 2>>();
+  for ( int i = 0; i < 4; ++i ) {
+    auto aligned = xul::make_pooled<Aligned>(*pool);
+    ASSERT_TRUE(aligned);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned.get()) % 256, 0);
+  }
+}
+
+TEST(StripoolObjectPool, OtherPools)
+{
+  xul::ArrayMaskedStripool<256, 1> pool;
+  int live = 0;
+  {
+    auto counted = xul::make_pooled<Counted>(pool, live);
+    ASSERT_TRUE(counted);
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+}
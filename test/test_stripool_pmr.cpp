@@ -0,0 +1,158 @@
+#include <xul/stripool_pmr.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+TEST(StripoolMemoryResource, HonoursAlignment)
+{
+  auto pool = std::make_unique<xul::ArrayStripool<8192, 4>>();
+  xul::StripoolMemoryResource resource{*pool};
+  for ( std::size_t alignment = 1; alignment <= xul::Stripool::max_alignment; alignment *= 2 ) {
+    void* mem = resource.allocate(100, alignment);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mem) % alignment, 0) << "Alignment " << alignment;
+    resource.deallocate(mem, 100, alignment);
+  }
+}
+
+TEST(StripoolMemoryResource, Containers)
+{
+  auto pool = std::make_unique<xul::ArrayStripool<1024, 4>>();
+  xul::StripoolMemoryResource resource{*pool};
+
+  struct alignas(64) CacheLine { int value; };
+  std::pmr::vector<CacheLine> lines{&resource};
+  for ( int i = 0; i < 8; ++i ) {
+    lines.push_back({i});
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(lines.data()) % 64, 0);
+  }
+  EXPECT_EQ(lines[7].value, 7);
+}
+
+TEST(StripoolMemoryResource, ThrowsWhenExhausted)
+{
+  xul::ArrayStripool<64, 1> pool;
+  xul::StripoolMemoryResource resource{pool};
+  void* mem = resource.allocate(64);
+  EXPECT_THROW((void)resource.allocate(64), std::bad_alloc);
+  resource.deallocate(mem, 64);
+}
+
+TEST(StripoolMemoryResource, OverflowsUpstream)
+{
+  xul::ArrayStripool<64, 2> pool;
+  std::pmr::unsynchronized_pool_resource upstream;
+  xul::StripoolMemoryResource resource{pool, &upstream};
+  EXPECT_EQ(resource.upstream_resource(), &upstream);
+
+  std::pmr::list<int> list{&resource};
+  for ( int i = 0; i < 8; ++i ) {
+    list.push_back(i);
+  }
+  // Only some of the nodes fit in the pool, with the rest allocated upstream.
+  const auto overflows = resource.overflows();
+  EXPECT_GT(overflows, 0);
+  EXPECT_LT(overflows, 8);
+  std::size_t pooled = 0;
+  for ( const int& value : list ) {
+    pooled += pool.owns(&value);
+  }
+  EXPECT_EQ(pooled, 8 - overflows);
+
+  // Each node goes back to wherever it came from.
+  list.clear();
+  EXPECT_NE(pool.acquire(64), nullptr);
+
+  // Alignments the pool can't cater for overflow too.
+  void* mem = resource.allocate(8, xul::Stripool::max_alignment * 2);
+  EXPECT_FALSE(pool.owns(mem));
+  EXPECT_EQ(resource.overflows(), overflows + 1);
+  resource.deallocate(mem, 8, xul::Stripool::max_alignment * 2);
+}
+
+TEST(StripoolMemoryResource, ComparesEqualWhenInterchangeable)
+{
+  xul::ArrayStripool<64, 1> pool1;
+  xul::ArrayStripool<64, 1> pool2;
+  std::pmr::unsynchronized_pool_resource upstream;
+  // Without an upstream, anything not from a resource's own pool is from
+  // another's, whichever pool it is.
+  xul::StripoolMemoryResource resource1{pool1};
+  xul::StripoolMemoryResource resource2{pool2};
+  EXPECT_TRUE(resource1.is_equal(resource2));
+  EXPECT_TRUE(resource2.is_equal(resource1));
+
+  // With one, only resources sharing a pool can tell overflows apart.
+  xul::StripoolMemoryResource overflowing1{pool1, &upstream};
+  xul::StripoolMemoryResource overflowing2{pool1, &upstream};
+  xul::StripoolMemoryResource otherPool{pool2, &upstream};
+  EXPECT_TRUE(overflowing1.is_equal(overflowing2));
+  EXPECT_FALSE(overflowing1.is_equal(otherPool));
+  EXPECT_FALSE(overflowing1.is_equal(resource1));
+  EXPECT_FALSE(resource1.is_equal(overflowing1));
+
+  EXPECT_FALSE(resource1.is_equal(upstream));
+  EXPECT_FALSE(upstream.is_equal(resource1));
+  EXPECT_FALSE(resource1.is_equal(*std::pmr::new_delete_resource()));
+}
+
+TEST(StripoolMemoryResource, ComparesUnequalWithForwardingResources)
+{
+  // Adaptor that is equal to whatever its upstream is equal to.
+  struct Forwarding : public std::pmr::memory_resource
+  {
+    explicit Forwarding(std::pmr::memory_resource& upstream_) : upstream{upstream_} {}
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override { return upstream.allocate(bytes, alignment); }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override { upstream.deallocate(p, bytes, alignment); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return upstream.is_equal(other); }
+    std::pmr::memory_resource& upstream;
+  };
+
+  xul::ArrayStripool<64, 1> pool;
+  xul::StripoolMemoryResource resource{pool};
+  Forwarding forwarding{resource};
+  EXPECT_TRUE(forwarding.is_equal(resource));
+  EXPECT_FALSE(resource.is_equal(forwarding));
+}
+
+TEST(StripoolMemoryResource, DeallocatesAcrossResources)
+{
+  xul::ArrayStripool<64, 1> pool1;
+  xul::ArrayStripool<64, 1> pool2;
+  xul::StripoolMemoryResource resource1{pool1};
+  xul::StripoolMemoryResource resource2{pool2};
+  void* acquired = resource1.allocate(64);
+  resource2.deallocate(acquired, 64);
+  EXPECT_NE(pool1.acquire(64), nullptr);
+
+  // Overflows go back upstream, whichever resource sharing the pool made them.
+  std::pmr::unsynchronized_pool_resource upstream;
+  xul::StripoolMemoryResource overflowing1{pool2, &upstream};
+  xul::StripoolMemoryResource overflowing2{pool2, &upstream};
+  void* overflowed = overflowing1.allocate(64, 128);
+  EXPECT_EQ(overflowing1.overflows(), 1);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(overflowed) % 128, 0);
+  overflowing2.deallocate(overflowed, 64, 128);
+}
+
+TEST(StripoolMemoryResource, MovesBetweenResourcesWithoutCopying)
+{
+  auto pool1 = std::make_unique<xul::ArrayStripool<1024, 2>>();
+  auto pool2 = std::make_unique<xul::ArrayStripool<1024, 2>>();
+  xul::StripoolMemoryResource resource1{*pool1};
+  xul::StripoolMemoryResource resource2{*pool2};
+
+  std::pmr::vector<int> ints1{{1, 2, 3}, &resource1};
+  std::pmr::vector<int> ints2{&resource2};
+  const int* data = ints1.data();
+  ints2 = std::move(ints1);
+  EXPECT_EQ(ints2.data(), data);
+  ints2.clear();
+  ints2.shrink_to_fit();
+  EXPECT_NE(pool1->acquire(1024), nullptr);
+}
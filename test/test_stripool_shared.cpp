@@ -0,0 +1,115 @@
+#include <xul/stripool_shared.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Run *child* in a forked process, returning its pid. The child exits with
+/// whatever the *child* returns, without running anything of the parent's.
+pid_t forked(auto child)
+{
+  const pid_t pid = ::fork();
+  if ( pid == 0 ) {
+    int status = 1;
+    try {
+      status = child();
+    } catch ( ... ) {
+    }
+    ::_exit(status);
+  }
+  return pid;
+}
+
+int exitStatus(pid_t pid)
+{
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+}
+
+TEST(SharedStripool, ReleasesAcrossProcesses)
+{
+  xul::SharedStripool pool{{.stripSize = 64, .stripCount = 1}};
+  int pipeFds[2];
+  ASSERT_EQ(::pipe(pipeFds), 0);
+
+  // One process acquires and fills the whole pool, and passes on the offset.
+  const pid_t producer = forked([&]{
+    char* acq = pool.acquire(64);
+    if ( !acq ) {
+      return 2;
+    }
+    std::strcpy(acq, "Hello from the producer");
+    const std::size_t offset = pool.offset_of(acq);
+    return ::write(pipeFds[1], &offset, sizeof(offset)) == sizeof(offset) ? 0 : 3;
+  });
+
+  // Another attaches to the pool afresh, so has it mapped elsewhere, reads
+  // the acquisition and releases it.
+  const pid_t consumer = forked([&]{
+    xul::SharedStripool attached{pool.fd()};
+    std::size_t offset;
+    if ( ::read(pipeFds[0], &offset, sizeof(offset)) != sizeof(offset) ) {
+      return 2;
+    }
+    char* acq = attached.at(offset);
+    if ( std::strcmp(acq, "Hello from the producer") != 0 ) {
+      return 3;
+    }
+    if ( attached.acquire(1) ) {
+      return 4;
+    }
+    attached.release(acq);
+    return 0;
+  });
+
+  EXPECT_EQ(exitStatus(producer), 0);
+  EXPECT_EQ(exitStatus(consumer), 0);
+  ::close(pipeFds[0]);
+  ::close(pipeFds[1]);
+
+  // The release reset the strip for everyone.
+  EXPECT_NE(pool.acquire(64), nullptr);
+}
+
+TEST(SharedStripool, AttachesByName)
+{
+  const std::string name = "/xul_test_stripool_" + std::to_string(::getpid());
+  xul::SharedStripool created{name.c_str(), {.stripSize = 128, .stripCount = 2, .layout = xul::StripLayout::isolated}};
+  xul::SharedStripool attached{name.c_str()};
+  xul::SharedStripool::unlink(name.c_str());
+  EXPECT_EQ(attached.mapped_size(), created.mapped_size());
+
+  char* acq = created.acquire(128);
+  ASSERT_NE(acq, nullptr);
+  std::fill_n(acq, 128, 'a');
+  char* seen = attached.at(created.offset_of(acq));
+  EXPECT_NE(seen, acq);
+  EXPECT_EQ(std::count(seen, seen + 128, 'a'), 128);
+
+  // Acquisitions from either are released by the other.
+  char* other = attached.acquire(128);
+  ASSERT_NE(other, nullptr);
+  EXPECT_EQ(created.acquire(1), nullptr);
+  attached.release(seen);
+  created.release(created.at(attached.offset_of(other)));
+  EXPECT_NE(created.acquire(128), nullptr);
+  EXPECT_NE(attached.acquire(128), nullptr);
+}
+
+TEST(SharedStripool, RejectsOtherMemory)
+{
+  xul::SharedStripool pool{{.stripSize = 64, .stripCount = 1}};
+  EXPECT_THROW((xul::BasicSharedStripool<xul::StripBookkeeping<std::uint64_t, 16>>{pool.fd()}), std::invalid_argument);
+  EXPECT_THROW((xul::SharedStripool{{.stripSize = 64, .stripCount = 0}}), std::invalid_argument);
+}
@@ -0,0 +1,73 @@
+#include <xul/stripool_size_classes.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+using Pool = xul::SizeClassStripool<
+  xul::StripSizeClass<16, 256, 2>,
+  xul::StripSizeClass<64, 256, 2>,
+  xul::StripSizeClass<512, 512, 2>>;
+
+static_assert(Pool::max_size == 512);
+static_assert(Pool::class_for(0) == 0);
+static_assert(Pool::class_for(16) == 0);
+static_assert(Pool::class_for(17) == 1);
+static_assert(Pool::class_for(64) == 1);
+static_assert(Pool::class_for(65) == 2);
+static_assert(Pool::class_for(512) == 2);
+
+/// Whether the *acq* was acquired from the *pool*.
+bool acquiredFrom(const char* acq, const auto& pool)
+{
+  const char* begin = static_cast<const char*>(pool.memory());
+  return acq >= begin && acq < begin + pool.raw_strip_size() * 2;
+}
+
+}
+
+TEST(SizeClassStripool, AcquiresFromSmallestClass)
+{
+  auto pool = std::make_unique<Pool>();
+  auto small = pool->acquire(8);
+  auto medium = pool->acquire(17);
+  auto large = pool->acquire(500);
+  EXPECT_TRUE(acquiredFrom(small, pool->class_pool<0>()));
+  EXPECT_TRUE(acquiredFrom(medium, pool->class_pool<1>()));
+  EXPECT_TRUE(acquiredFrom(large, pool->class_pool<2>()));
+
+  EXPECT_EQ(pool->acquire(513), nullptr);
+  EXPECT_EQ(pool->acquire(UINT32_MAX), nullptr);
+
+  Pool::release(small);
+  Pool::release(medium);
+  Pool::release(large);
+}
+
+TEST(SizeClassStripool, SpillsToLargerClasses)
+{
+  auto pool = std::make_unique<Pool>();
+  std::vector<char*> acqs;
+  // Exhaust the smallest class, which then spills into the next.
+  while ( char* acq = pool->acquire(16) ) {
+    if ( !acquiredFrom(acq, pool->class_pool<0>()) ) {
+      EXPECT_TRUE(acquiredFrom(acq, pool->class_pool<1>()));
+      acqs.push_back(acq);
+      break;
+    }
+    acqs.push_back(acq);
+  }
+  EXPECT_TRUE(acquiredFrom(acqs.back(), pool->class_pool<1>()));
+
+  // Releases go back to the pools they came from, so the smallest class is
+  // used again.
+  for ( auto acq : acqs ) {
+    Pool::release(acq);
+  }
+  auto acq = pool->acquire(16);
+  EXPECT_TRUE(acquiredFrom(acq, pool->class_pool<0>()));
+  Pool::release(acq);
+}
@@ -0,0 +1,122 @@
+#include <xul/stripool_trace.hpp>
+#include <xul/stripool_dynamic.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+TEST(StripoolTrace, RecordsAcquisitionsAndReleases)
+{
+  xul::ArrayStripool<64, 2> pool;
+  std::stringstream trace;
+  {
+    xul::TracingStripool tracing{pool, trace};
+    char* first = tracing.acquire(64);
+    char* second = tracing.acquire(32);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(tracing.acquire(64), nullptr);
+    tracing.release(first);
+    tracing.release(second);
+  }
+
+  const auto events = xul::read_strip_trace(trace);
+  ASSERT_EQ(events.size(), 5u);
+  EXPECT_EQ(events[0].lifetime, 0u);
+  EXPECT_EQ(events[0].size, 64u);
+  EXPECT_EQ(events[1].lifetime, 1u);
+  EXPECT_EQ(events[1].size, 32u);
+  EXPECT_EQ(events[2].lifetime, 2u);
+  EXPECT_FALSE(events[2].is_release());
+  EXPECT_TRUE(events[3].is_release());
+  EXPECT_EQ(events[3].lifetime, 0u);
+  EXPECT_TRUE(events[4].is_release());
+  EXPECT_EQ(events[4].lifetime, 1u);
+  EXPECT_EQ(events[0].thread, events[4].thread);
+  EXPECT_LE(events[0].nanos, events[4].nanos);
+}
+
+TEST(StripoolTrace, ReplaysAgainstOtherPools)
+{
+  // Four acquisitions live at once, each filling a strip of 64.
+  std::stringstream trace;
+  {
+    xul::ArrayStripool<64, 4> pool;
+    xul::TracingStripool tracing{pool, trace};
+    for ( int round = 0; round < 3; ++round ) {
+      char* acqs[4];
+      for ( char*& acq : acqs ) {
+        acq = tracing.acquire(64);
+      }
+      for ( char* acq : acqs ) {
+        tracing.release(acq);
+      }
+    }
+  }
+  const auto events = xul::read_strip_trace(trace);
+
+  xul::ArrayStripool<64, 4> same;
+  const auto enough = xul::replay_strip_trace(events, same);
+  EXPECT_EQ(enough.acquires, 12u);
+  EXPECT_EQ(enough.failures, 0u);
+  EXPECT_EQ(enough.peakStripsInUse, 4u);
+
+  xul::ArrayStripool<64, 3> fewer;
+  const auto tooFew = xul::replay_strip_trace(events, fewer);
+  EXPECT_EQ(tooFew.failures, 3u);
+  EXPECT_DOUBLE_EQ(tooFew.failure_rate(), 0.25);
+  EXPECT_EQ(tooFew.peakStripsInUse, 3u);
+
+  // Strips large enough for every acquisition use a single strip.
+  xul::DynamicStripool larger{{.stripSize = 1024, .stripCount = 2}};
+  const auto packed = xul::replay_strip_trace(events, larger);
+  EXPECT_EQ(packed.failures, 0u);
+  EXPECT_EQ(packed.peakStripsInUse, 1u);
+
+  // Replaying leaves the pools as they were.
+  EXPECT_EQ(xul::replay_strip_trace(events, fewer).failures, 3u);
+}
+
+TEST(StripoolTrace, ReleasesFailedAcquisitionsOnReplay)
+{
+  // Each round, an acquisition fails for want of a second strip, and the
+  // caller makes do without it.
+  std::stringstream trace;
+  {
+    xul::ArrayStripool<64, 1> pool;
+    xul::TracingStripool tracing{pool, trace};
+    for ( int round = 0; round < 3; ++round ) {
+      char* held = tracing.acquire(64);
+      EXPECT_EQ(tracing.acquire(64), nullptr);
+      tracing.release(held);
+    }
+  }
+  const auto events = xul::read_strip_trace(trace);
+  ASSERT_EQ(events.size(), 9u);
+  EXPECT_FALSE(events[0].failed);
+  EXPECT_TRUE(events[1].failed);
+
+  // With room for it, the failed acquisition is released straight away, so
+  // doesn't crowd out later rounds.
+  xul::ArrayStripool<64, 2> larger;
+  const auto replay = xul::replay_strip_trace(events, larger);
+  EXPECT_EQ(replay.acquires, 6u);
+  EXPECT_EQ(replay.failures, 0u);
+  EXPECT_EQ(replay.peakStripsInUse, 1u);
+}
+
+TEST(StripoolTrace, RejectsOtherStreams)
+{
+  std::stringstream notTrace{"not a trace at all"};
+  EXPECT_THROW(xul::read_strip_trace(notTrace), std::invalid_argument);
+
+  std::stringstream truncated;
+  {
+    xul::ArrayStripool<64, 1> pool;
+    xul::TracingStripool tracing{pool, truncated};
+    tracing.release(tracing.acquire(8));
+  }
+  std::stringstream cut{truncated.str().substr(0, truncated.str().size() - 1)};
+  EXPECT_THROW(xul::read_strip_trace(cut), std::invalid_argument);
+}